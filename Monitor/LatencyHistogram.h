@@ -0,0 +1,111 @@
+#ifndef __MONITOR_LATENCYHISTOGRAM_H
+#define __MONITOR_LATENCYHISTOGRAM_H
+
+#include "Module.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Counts durations (in microseconds) in a fixed set of buckets, from 1ms up to 5s plus everything beyond.
+    // The bounds are fixed so histograms of different observables, and of different devices, can be added up.
+    class LatencyHistogram {
+    public:
+        static constexpr uint8_t Buckets = 13;
+
+    public:
+        LatencyHistogram()
+            : _counts()
+            , _count(0)
+            , _sum(0)
+            , _max(0)
+        {
+            Reset();
+        }
+        LatencyHistogram(const LatencyHistogram& copy)
+            : _counts()
+            , _count(copy._count)
+            , _sum(copy._sum)
+            , _max(copy._max)
+        {
+            ::memcpy(_counts, copy._counts, sizeof(_counts));
+        }
+        ~LatencyHistogram()
+        {
+        }
+
+        LatencyHistogram& operator=(const LatencyHistogram& RHS)
+        {
+            ::memcpy(_counts, RHS._counts, sizeof(_counts));
+            _count = RHS._count;
+            _sum = RHS._sum;
+            _max = RHS._max;
+
+            return (*this);
+        }
+
+    public:
+        // Upper bound (inclusive) of a bucket in microseconds, the last bucket has no bound (~0).
+        static uint64_t Bound(const uint8_t index)
+        {
+            static const uint64_t bounds[Buckets] = {
+                1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, static_cast<uint64_t>(~0)
+            };
+
+            ASSERT(index < Buckets);
+
+            return (bounds[index]);
+        }
+        void Add(const uint64_t duration)
+        {
+            uint8_t index = 0;
+
+            while (duration > Bound(index)) {
+                index++;
+            }
+
+            _counts[index]++;
+            _count++;
+            _sum += duration;
+
+            if (duration > _max) {
+                _max = duration;
+            }
+        }
+        void Reset()
+        {
+            ::memset(_counts, 0, sizeof(_counts));
+            _count = 0;
+            _sum = 0;
+            _max = 0;
+        }
+
+        // Number of durations in the given bucket only, not including the lower buckets.
+        inline uint32_t Count(const uint8_t index) const
+        {
+            ASSERT(index < Buckets);
+
+            return (_counts[index]);
+        }
+        inline uint32_t Count() const
+        {
+            return (_count);
+        }
+        inline uint64_t Sum() const
+        {
+            return (_sum);
+        }
+        inline uint64_t Max() const
+        {
+            return (_max);
+        }
+
+    private:
+        uint32_t _counts[Buckets];
+        uint32_t _count;
+        uint64_t _sum;
+        uint64_t _max;
+    };
+}
+}
+
+#endif // __MONITOR_LATENCYHISTOGRAM_H
@@ -0,0 +1,113 @@
+#ifndef __MONITOR_LEAKDETECTOR_H
+#define __MONITOR_LEAKDETECTOR_H
+
+#include "Module.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Estimates the trend of the resident memory with an exponentially weighted least squares fit over the
+    // measurements, so the most recent "window" measurements dominate. From the fitted line it predicts how
+    // long it takes before a threshold is reached. The sums are kept relative to the latest measurement,
+    // which keeps them small and makes the intercept the current (smoothed) value.
+    class LeakDetector {
+    public:
+        LeakDetector() = delete;
+        LeakDetector& operator=(const LeakDetector&) = delete;
+
+        LeakDetector(const uint16_t window)
+            : _decay(window > 1 ? 1.0 - (1.0 / window) : 0.0)
+            , _required(window / 2 > 3 ? window / 2 : 3)
+            , _count(0)
+            , _last(0)
+            , _w(0)
+            , _x(0)
+            , _y(0)
+            , _xx(0)
+            , _xy(0)
+        {
+        }
+        LeakDetector(const LeakDetector& copy)
+            : _decay(copy._decay)
+            , _required(copy._required)
+            , _count(copy._count)
+            , _last(copy._last)
+            , _w(copy._w)
+            , _x(copy._x)
+            , _y(copy._y)
+            , _xx(copy._xx)
+            , _xy(copy._xy)
+        {
+        }
+        ~LeakDetector()
+        {
+        }
+
+    public:
+        void Reset()
+        {
+            _count = 0;
+            _last = 0;
+            _w = _x = _y = _xx = _xy = 0;
+        }
+        void Add(const uint64_t time, const uint64_t value)
+        {
+            if ((_count != 0) && (time > _last)) {
+                // Move the origin to the new measurement, x is in seconds in the past (so negative).
+                double shift = static_cast<double>(time - _last) / (1000 * 1000);
+
+                _xx = _decay * (_xx - (2 * shift * _x) + (shift * shift * _w));
+                _xy = _decay * (_xy - (shift * _y));
+                _x = _decay * (_x - (shift * _w));
+                _y = _decay * _y;
+                _w = _decay * _w;
+            }
+
+            // The new measurement sits at x = 0, so it only adds to the weight and the sum of y.
+            _w += 1.0;
+            _y += static_cast<double>(value);
+
+            _last = time;
+            _count++;
+        }
+
+        // Seconds before the trend reaches the threshold. Returns false if there are not enough measurements
+        // yet or if the trend is not rising.
+        bool Remaining(const uint64_t threshold, uint64_t& seconds) const
+        {
+            bool result = false;
+
+            if (_count >= _required) {
+                double denominator = (_w * _xx) - (_x * _x);
+
+                if (denominator > 0) {
+                    double slope = ((_w * _xy) - (_x * _y)) / denominator;
+                    double current = (_y - (slope * _x)) / _w;
+
+                    if (slope > 0) {
+                        double left = static_cast<double>(threshold) - current;
+
+                        seconds = (left > 0 ? static_cast<uint64_t>(left / slope) : 0);
+                        result = true;
+                    }
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        const double _decay;
+        const uint32_t _required;
+        uint32_t _count;
+        uint64_t _last;
+        double _w;
+        double _x;
+        double _y;
+        double _xx;
+        double _xy;
+    };
+}
+}
+
+#endif // __MONITOR_LEAKDETECTOR_H
@@ -0,0 +1,268 @@
+#ifndef __MONITOR_MEASUREMENTHISTORY_H
+#define __MONITOR_MEASUREMENTHISTORY_H
+
+#include "Module.h"
+#include <algorithm>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Keeps the measurements of an observable over time, in a fixed amount of memory. Every measurement is
+    // stored as is in the RAW ring and averaged into buckets of a minute and of an hour, each in a ring of
+    // its own. Once a ring is full, the oldest entry is overwritten. The peak resident memory and CPU load
+    // are kept per bucket as well, so spikes do not get lost in the averages.
+    class MeasurementHistory {
+    public:
+        enum resolution : uint8_t {
+            RAW = 0,
+            MINUTE = 1,
+            HOUR = 2,
+            AUTO = 0xFF
+        };
+
+        static constexpr uint8_t Resolutions = 3;
+
+        struct Sample {
+            uint64_t Time; // Start of the bucket, in microseconds since the epoch.
+            uint64_t Resident;
+            uint64_t PeakResident;
+            uint64_t Allocated;
+            uint64_t Shared;
+            uint32_t CPU;
+            uint32_t PeakCPU;
+            uint8_t Process;
+        };
+
+    private:
+        class Tier {
+        public:
+            Tier& operator=(const Tier&) = delete;
+
+            Tier(const uint16_t size, const uint64_t period)
+                : _samples(size)
+                , _period(period)
+                , _head(0)
+                , _count(0)
+                , _slot(0)
+                , _entries(0)
+                , _resident(0)
+                , _allocated(0)
+                , _shared(0)
+                , _cpu(0)
+                , _process(0)
+                , _peakResident(0)
+                , _peakCPU(0)
+            {
+            }
+            Tier(const Tier& copy)
+                : _samples(copy._samples)
+                , _period(copy._period)
+                , _head(copy._head)
+                , _count(copy._count)
+                , _slot(copy._slot)
+                , _entries(copy._entries)
+                , _resident(copy._resident)
+                , _allocated(copy._allocated)
+                , _shared(copy._shared)
+                , _cpu(copy._cpu)
+                , _process(copy._process)
+                , _peakResident(copy._peakResident)
+                , _peakCPU(copy._peakCPU)
+            {
+            }
+            ~Tier()
+            {
+            }
+
+        public:
+            inline bool IsEnabled() const
+            {
+                return (_samples.size() > 0);
+            }
+            inline uint16_t Count() const
+            {
+                return (_count);
+            }
+            inline uint64_t Oldest() const
+            {
+                return (_count == 0 ? static_cast<uint64_t>(~0) : At(0).Time);
+            }
+            // Index 0 is the oldest sample.
+            inline const Sample& At(const uint16_t index) const
+            {
+                return (_samples[(_head + _samples.size() - _count + index) % _samples.size()]);
+            }
+            void Add(const Sample& sample)
+            {
+                if (_samples.size() > 0) {
+                    if (_period == 0) {
+                        Push(sample);
+                    } else {
+                        uint64_t slot = sample.Time / _period;
+
+                        if ((_entries != 0) && (slot != _slot)) {
+                            Flush();
+                        }
+
+                        _slot = slot;
+                        _entries++;
+                        _resident += sample.Resident;
+                        _allocated += sample.Allocated;
+                        _shared += sample.Shared;
+                        _cpu += sample.CPU;
+                        _process += sample.Process;
+                        _peakResident = std::max(_peakResident, sample.PeakResident);
+                        _peakCPU = std::max(_peakCPU, sample.PeakCPU);
+                    }
+                }
+            }
+
+        private:
+            void Push(const Sample& sample)
+            {
+                _samples[_head] = sample;
+                _head = static_cast<uint16_t>((_head + 1) % _samples.size());
+
+                if (_count < _samples.size()) {
+                    _count++;
+                }
+            }
+            void Flush()
+            {
+                Sample sample;
+
+                sample.Time = _slot * _period;
+                sample.Resident = _resident / _entries;
+                sample.PeakResident = _peakResident;
+                sample.Allocated = _allocated / _entries;
+                sample.Shared = _shared / _entries;
+                sample.CPU = static_cast<uint32_t>(_cpu / _entries);
+                sample.PeakCPU = _peakCPU;
+                sample.Process = static_cast<uint8_t>(_process / _entries);
+
+                Push(sample);
+
+                _entries = 0;
+                _resident = 0;
+                _allocated = 0;
+                _shared = 0;
+                _cpu = 0;
+                _process = 0;
+                _peakResident = 0;
+                _peakCPU = 0;
+            }
+
+        private:
+            std::vector<Sample> _samples;
+            const uint64_t _period;
+            uint16_t _head;
+            uint16_t _count;
+
+            // Accumulation of the bucket being filled.
+            uint64_t _slot;
+            uint32_t _entries;
+            uint64_t _resident;
+            uint64_t _allocated;
+            uint64_t _shared;
+            uint64_t _cpu;
+            uint32_t _process;
+            uint64_t _peakResident;
+            uint32_t _peakCPU;
+        };
+
+    public:
+        MeasurementHistory() = delete;
+        MeasurementHistory& operator=(const MeasurementHistory&) = delete;
+
+        MeasurementHistory(const uint16_t samples, const uint16_t minutes, const uint16_t hours)
+            : _adminLock()
+            , _tiers { Tier(samples, 0), Tier(minutes, 60ULL * 1000 * 1000), Tier(hours, 60ULL * 60 * 1000 * 1000) }
+        {
+        }
+        MeasurementHistory(const MeasurementHistory& copy)
+            : _adminLock()
+            , _tiers { copy._tiers[RAW], copy._tiers[MINUTE], copy._tiers[HOUR] }
+        {
+        }
+        ~MeasurementHistory()
+        {
+        }
+
+    public:
+        void Add(const uint64_t time, const uint64_t resident, const uint64_t allocated, const uint64_t shared, const uint8_t process, const uint32_t cpu)
+        {
+            Sample sample;
+
+            sample.Time = time;
+            sample.Resident = resident;
+            sample.PeakResident = resident;
+            sample.Allocated = allocated;
+            sample.Shared = shared;
+            sample.CPU = cpu;
+            sample.PeakCPU = cpu;
+            sample.Process = process;
+
+            _adminLock.Lock();
+
+            for (uint8_t index = 0; index < Resolutions; index++) {
+                _tiers[index].Add(sample);
+            }
+
+            _adminLock.Unlock();
+        }
+
+        // Reports the samples with a time in [from, to], oldest first, at the requested resolution. With AUTO,
+        // the finest resolution that still reaches back to "from" is used. Returns the resolution used.
+        template <typename ACTION>
+        resolution Range(const uint64_t from, const uint64_t to, const resolution requested, ACTION action) const
+        {
+            resolution result = requested;
+
+            _adminLock.Lock();
+
+            if (result == AUTO) {
+                uint64_t oldest = static_cast<uint64_t>(~0);
+
+                result = RAW;
+
+                for (uint8_t index = 0; index < Resolutions; index++) {
+                    if ((_tiers[index].IsEnabled() == true) && (_tiers[index].Oldest() < oldest)) {
+                        oldest = _tiers[index].Oldest();
+                        result = static_cast<resolution>(index);
+
+                        if (oldest <= from) {
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if (result < Resolutions) {
+                const Tier& tier(_tiers[result]);
+
+                for (uint16_t index = 0; index < tier.Count(); index++) {
+                    const Sample& sample(tier.At(index));
+
+                    if ((sample.Time >= from) && (sample.Time <= to)) {
+                        action(sample);
+                    }
+                }
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+        static uint64_t Period(const resolution which)
+        {
+            return (which == MINUTE ? 60 : (which == HOUR ? 60 * 60 : 0));
+        }
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        Tier _tiers[Resolutions];
+    };
+}
+}
+
+#endif // __MONITOR_MEASUREMENTHISTORY_H
@@ -0,0 +1,268 @@
+#ifndef __MONITOR_MEMORYPRESSURE_H
+#define __MONITOR_MEMORYPRESSURE_H
+
+#include "Module.h"
+
+#include <atomic>
+
+#ifndef __WIN32__
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Reports memory pressure as it happens, rather than waiting for the next measurement. A PSI trigger
+    // (/proc/pressure/memory) fires if tasks stalled on memory for more than "stall" within "window", and the
+    // memory.events of the cgroup v2 a plugin runs in fires whenever its high/max/oom counters change. Both
+    // are pollable, so they are handed to the resource monitor and cost nothing as long as all is quiet.
+    class MemoryPressure {
+    public:
+        struct ICallback {
+            virtual ~ICallback() {}
+            virtual void Pressure() = 0;
+        };
+
+    private:
+        class Source : public Core::IResource {
+        public:
+            Source() = delete;
+            Source(const Source&) = delete;
+            Source& operator=(const Source&) = delete;
+
+            Source(MemoryPressure& parent, const string& path, const string& trigger)
+                : _parent(parent)
+                , _path(path)
+                , _trigger(trigger.empty() == false)
+                , _descriptor(-1)
+                , _stale(false)
+            {
+#ifndef __WIN32__
+                _descriptor = ::open(_path.c_str(), (_trigger == true ? O_RDWR : O_RDONLY) | O_NONBLOCK | O_CLOEXEC);
+
+                if ((_descriptor != -1) && (_trigger == true) && (::write(_descriptor, trigger.c_str(), trigger.length() + 1) < 0)) {
+                    TRACE_L1("Could not set the pressure trigger on %s, error: %d", _path.c_str(), errno);
+                    ::close(_descriptor);
+                    _descriptor = -1;
+                }
+                if (_descriptor != -1) {
+                    if (_trigger == false) {
+                        // Consume the current content, only changes from now on are of interest.
+                        Consume();
+                    }
+                    Core::ResourceMonitor::Instance().Register(*this);
+                }
+#endif
+            }
+            ~Source() override
+            {
+#ifndef __WIN32__
+                if (_descriptor != -1) {
+                    Core::ResourceMonitor::Instance().Unregister(*this);
+                    ::close(_descriptor);
+                    _descriptor = -1;
+                }
+#endif
+            }
+
+        public:
+            inline bool IsValid() const
+            {
+                return (_descriptor != -1);
+            }
+            inline bool IsStale() const
+            {
+                return (_stale.load());
+            }
+            inline const string& Path() const
+            {
+                return (_path);
+            }
+
+        private:
+            Core::IResource::handle Descriptor() const override
+            {
+                return (_descriptor);
+            }
+            uint16_t Events() override
+            {
+                return ((_descriptor != -1) && (_stale == false) ? (POLLPRI | POLLERR) : 0);
+            }
+            void Handle(const uint16_t events) override
+            {
+                if (_stale == false) {
+                    if (_trigger == true) {
+                        if ((events & POLLERR) != 0) {
+                            // The trigger is gone, nothing will ever be reported again.
+                            _stale = true;
+                        } else if ((events & POLLPRI) != 0) {
+                            _parent.Notify();
+                        }
+                    } else if ((events & (POLLPRI | POLLERR)) != 0) {
+                        // A change of a cgroup file is reported until it is read again. If it can not be read, the
+                        // cgroup is removed.
+                        if (Consume() == false) {
+                            _stale = true;
+                        } else {
+                            _parent.Notify();
+                        }
+                    }
+                }
+            }
+            bool Consume()
+            {
+                bool result = false;
+#ifndef __WIN32__
+                char buffer[256];
+
+                if (::lseek(_descriptor, 0, SEEK_SET) == 0) {
+                    result = (::read(_descriptor, buffer, sizeof(buffer)) > 0);
+                }
+#endif
+                return (result);
+            }
+
+        private:
+            MemoryPressure& _parent;
+            const string _path;
+            const bool _trigger;
+            int _descriptor;
+            std::atomic<bool> _stale;
+        };
+
+    public:
+        MemoryPressure() = delete;
+        MemoryPressure(const MemoryPressure&) = delete;
+        MemoryPressure& operator=(const MemoryPressure&) = delete;
+
+        MemoryPressure(ICallback* callback, const uint32_t stall, const uint32_t window)
+            : _adminLock()
+            , _callback(callback)
+            , _psi(nullptr)
+            , _cgroups()
+            , _root(CGroup(_T("self")))
+        {
+            ASSERT(callback != nullptr);
+
+            // Stall and window are configured in milliseconds, the kernel wants microseconds.
+            _psi = new Source(*this, _T("/proc/pressure/memory"), _T("some ") + Core::NumberType<uint32_t>(stall * 1000).Text() + _T(" ") + Core::NumberType<uint32_t>(window * 1000).Text());
+
+            if (_psi->IsValid() == false) {
+                SYSLOG(Logging::Startup, (_T("Memory pressure (PSI) is not available, measuring periodically only.")));
+            }
+        }
+        ~MemoryPressure()
+        {
+            delete _psi;
+
+            std::list<Source*>::iterator index(_cgroups.begin());
+
+            while (index != _cgroups.end()) {
+                delete (*index);
+                index++;
+            }
+        }
+
+    public:
+        inline bool IsValid() const
+        {
+            return (_psi->IsValid());
+        }
+
+        // Also watch the memory.events of the cgroup the given process lives in, if it is not our own.
+        void Watch(const uint32_t pid)
+        {
+            string group(CGroup(Core::NumberType<uint32_t>(pid).Text()));
+
+            if ((group.empty() == false) && (group != _T("/")) && (group != _root)) {
+                string path(_T("/sys/fs/cgroup") + group + _T("/memory.events"));
+
+                _adminLock.Lock();
+
+                std::list<Source*>::const_iterator index(_cgroups.begin());
+
+                while ((index != _cgroups.end()) && ((*index)->Path() != path)) {
+                    index++;
+                }
+
+                if (index == _cgroups.end()) {
+                    Source* source = new Source(*this, path, string());
+
+                    if (source->IsValid() == true) {
+                        _cgroups.push_back(source);
+                    } else {
+                        delete source;
+                    }
+                }
+
+                _adminLock.Unlock();
+            }
+        }
+
+        // Sources can not be removed from within the resource monitor, clean up the ones that are gone from here.
+        void Cleanup()
+        {
+            _adminLock.Lock();
+
+            std::list<Source*>::iterator index(_cgroups.begin());
+
+            while (index != _cgroups.end()) {
+                if ((*index)->IsStale() == true) {
+                    delete (*index);
+                    index = _cgroups.erase(index);
+                } else {
+                    index++;
+                }
+            }
+
+            _adminLock.Unlock();
+        }
+
+    private:
+        inline void Notify()
+        {
+            _callback->Pressure();
+        }
+        // The cgroup v2 path of a process, an empty string if it is not in a (v2) cgroup.
+        static string CGroup(const string& process)
+        {
+            string result;
+#ifndef __WIN32__
+            char buffer[1024];
+            int fd = ::open((_T("/proc/") + process + _T("/cgroup")).c_str(), O_RDONLY | O_CLOEXEC);
+
+            if (fd != -1) {
+                ssize_t length = ::read(fd, buffer, sizeof(buffer) - 1);
+
+                if (length > 0) {
+                    buffer[length] = '\0';
+
+                    // The unified hierarchy is listed as "0::<path>".
+                    const char* line = ::strstr(buffer, "0::");
+
+                    if ((line != nullptr) && ((line == buffer) || (line[-1] == '\n'))) {
+                        const char* end = ::strchr(line, '\n');
+
+                        result = (end == nullptr ? string(&(line[3])) : string(&(line[3]), end - &(line[3])));
+                    }
+                }
+
+                ::close(fd);
+            }
+#endif
+            return (result);
+        }
+
+    private:
+        Core::CriticalSection _adminLock;
+        ICallback* _callback;
+        Source* _psi;
+        std::list<Source*> _cgroups;
+        const string _root;
+    };
+}
+}
+
+#endif // __MONITOR_MEMORYPRESSURE_H
@@ -1,6 +1,16 @@
 #include "Monitor.h"
 
 namespace WPEFramework {
+
+ENUM_CONVERSION_BEGIN(Plugin::MeasurementHistory::resolution)
+
+    { Plugin::MeasurementHistory::resolution::RAW, _TXT("raw") },
+    { Plugin::MeasurementHistory::resolution::MINUTE, _TXT("minute") },
+    { Plugin::MeasurementHistory::resolution::HOUR, _TXT("hour") },
+    { Plugin::MeasurementHistory::resolution::AUTO, _TXT("auto") },
+
+    ENUM_CONVERSION_END(Plugin::MeasurementHistory::resolution);
+
 namespace Plugin {
 
     SERVICE_REGISTRATION(Monitor, 1, 0);
@@ -8,6 +18,8 @@ namespace Plugin {
     static Core::ProxyPoolType<Web::JSONBodyType<Core::JSON::ArrayType<Monitor::Data>>> jsonBodyDataFactory(2);
     static Core::ProxyPoolType<Web::JSONBodyType<Monitor::Data>> jsonBodyParamFactory(2);
     static Core::ProxyPoolType<Web::JSONBodyType<Monitor::Data::MetaData>> jsonMemoryBodyDataFactory(2);
+    static Core::ProxyPoolType<Web::JSONBodyType<Monitor::Data::History>> jsonHistoryBodyDataFactory(2);
+    static Core::ProxyPoolType<Web::TextBody> textBodyMetricsFactory(2);
 
     /* virtual */ const string Monitor::Initialize(PluginHost::IShell* service)
     {
@@ -19,7 +31,7 @@ namespace Plugin {
         Core::JSON::ArrayType<Config::Entry>::Iterator index(_config.Observables.Elements());
 
         // Create a list of plugins to monitor..
-        _monitor->Open(service, index);
+        _monitor->Open(service, index, _config.Pressure);
 
         // During the registartion, all Plugins, currently active are reported to the sink.
         service->Register(_monitor);
@@ -49,7 +61,9 @@ namespace Plugin {
     }
 
     // <GET> ../				Get all Memory Measurments
+    // <GET> ../metrics			Get all Measurements and restart counts in the Prometheus text format (0.0.4)
     // <GET> ../<Callsign>		Get the Memory Measurements for Callsign
+    // <GET> ../<Callsign>/History?from=<seconds>&to=<seconds>&resolution=<raw|minute|hour|auto>	Get the recorded Measurements for Callsign
     // <PUT> ../<Callsign>		Reset the Memory measurements for Callsign
     /* virtual */ Core::ProxyType<Web::Response> Monitor::Process(const Web::Request& request)
     {
@@ -65,7 +79,16 @@ namespace Plugin {
         result->ErrorCode = Web::STATUS_OK;
         result->Message = "OK";
 
-        if (request.Verb == Web::Request::HTTP_GET) {
+        // The metrics go before the observables: a GET of an observable called "metrics" gets the metrics,
+        // its own measurements are in the list of all of them (GET ../) and over JSON-RPC.
+        if ((request.Verb == Web::Request::HTTP_GET) && (index.Remainder() == _T("metrics"))) {
+            Core::ProxyType<Web::TextBody> response(textBodyMetricsFactory.Element());
+
+            _monitor->Metrics(*response);
+
+            result->Body<Web::TextBody>(response);
+            result->ContentType = Web::MIME_TEXT;
+        } else if (request.Verb == Web::Request::HTTP_GET) {
             // Let's list them all....
             if (index.Next() == false) {
                 if (_monitor->Length() > 0) {
@@ -76,15 +99,38 @@ namespace Plugin {
                     result->Body(Core::proxy_cast<Web::IBody>(response));
                 }
             } else {
-                MetaData memoryInfo;
-
-                // Seems we only want 1 name
-                if (_monitor->Snapshot(index.Current().Text(), memoryInfo) == true) {
-                    Core::ProxyType<Web::JSONBodyType<Monitor::Data::MetaData>> response(jsonMemoryBodyDataFactory.Element());
-
-                    *response = memoryInfo;
-
-                    result->Body(Core::proxy_cast<Web::IBody>(response));
+                string callsign(index.Current().Text());
+
+                if ((index.Next() == true) && (index.Current() == _T("History"))) {
+                    Core::ProxyType<Web::JSONBodyType<Monitor::Data::History>> response(jsonHistoryBodyDataFactory.Element());
+                    Core::URL::KeyValue options(request.Query.IsSet() == true ? request.Query.Value() : string());
+                    Core::EnumerateType<MeasurementHistory::resolution> resolution(Core::TextFragment(options[_T("resolution")]));
+
+                    response->Clear();
+
+                    if (_monitor->History(
+                            callsign,
+                            options.Number<uint64_t>(_T("from"), 0),
+                            options.Number<uint64_t>(_T("to"), static_cast<uint64_t>(~0)),
+                            (resolution.IsSet() == true ? resolution.Value() : MeasurementHistory::AUTO),
+                            *response) == true) {
+
+                        result->Body(Core::proxy_cast<Web::IBody>(response));
+                    } else {
+                        result->ErrorCode = Web::STATUS_NOT_FOUND;
+                        result->Message = _T("Unknown observable: ") + callsign;
+                    }
+                } else {
+                    MetaData memoryInfo;
+
+                    // Seems we only want 1 name
+                    if (_monitor->Snapshot(callsign, memoryInfo) == true) {
+                        Core::ProxyType<Web::JSONBodyType<Monitor::Data::MetaData>> response(jsonMemoryBodyDataFactory.Element());
+
+                        *response = memoryInfo;
+
+                        result->Body(Core::proxy_cast<Web::IBody>(response));
+                    }
                 }
             }
 
@@ -2,8 +2,17 @@
 #define __MONITOR_H
 
 #include "Module.h"
+#include "LatencyHistogram.h"
+#include "LeakDetector.h"
+#include "MeasurementHistory.h"
+#include "MemoryPressure.h"
+#include "OpenMetrics.h"
+#include "ProcessMemory.h"
+#include "ProcessUsage.h"
+#include "TimerWheel.h"
 #include <interfaces/IMemory.h>
 #include <interfaces/json/JsonData_Monitor.h>
+#include <atomic>
 #include <limits>
 #include <string>
 
@@ -69,14 +78,148 @@ namespace Plugin {
             Settings Operational;
         };
 
+        class HistoryInfo : public Core::JSON::Container {
+        public:
+            HistoryInfo& operator=(const HistoryInfo&) = delete;
+
+            HistoryInfo()
+                : Core::JSON::Container()
+                , Samples(120)
+                , Minutes(60)
+                , Hours(24)
+            {
+                Add(_T("samples"), &Samples);
+                Add(_T("minutes"), &Minutes);
+                Add(_T("hours"), &Hours);
+            }
+            HistoryInfo(const HistoryInfo& copy)
+                : Core::JSON::Container()
+                , Samples(copy.Samples)
+                , Minutes(copy.Minutes)
+                , Hours(copy.Hours)
+            {
+                Add(_T("samples"), &Samples);
+                Add(_T("minutes"), &Minutes);
+                Add(_T("hours"), &Hours);
+            }
+            virtual ~HistoryInfo()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt16 Samples; // Number of measurements kept as is.
+            Core::JSON::DecUInt16 Minutes; // Number of 1 minute averages kept.
+            Core::JSON::DecUInt16 Hours; // Number of 1 hour averages kept.
+        };
+
+        class LeakInfo : public Core::JSON::Container {
+        public:
+            LeakInfo& operator=(const LeakInfo&) = delete;
+
+            LeakInfo()
+                : Core::JSON::Container()
+                , Window(60)
+                , Horizon(0)
+                , Quiet(10)
+            {
+                Add(_T("window"), &Window);
+                Add(_T("horizon"), &Horizon);
+                Add(_T("quiet"), &Quiet);
+            }
+            LeakInfo(const LeakInfo& copy)
+                : Core::JSON::Container()
+                , Window(copy.Window)
+                , Horizon(copy.Horizon)
+                , Quiet(copy.Quiet)
+            {
+                Add(_T("window"), &Window);
+                Add(_T("horizon"), &Horizon);
+                Add(_T("quiet"), &Quiet);
+            }
+            virtual ~LeakInfo()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt16 Window; // Number of measurements that dominate the trend.
+            Core::JSON::DecUInt32 Horizon; // Seconds, restart if the memorylimit is predicted to be hit within this time, 0 is off.
+            Core::JSON::DecUInt8 Quiet; // Percent CPU, below this load it is a good moment for the restart.
+        };
+
     public:
         class MetaData {
+        public:
+            // The memory breakdown of one of the processes of the observable.
+            class Footprint {
+            public:
+                Footprint() = delete;
+
+                Footprint(const uint32_t id)
+                    : _id(id)
+                    , _pss()
+                    , _privateClean()
+                    , _privateDirty()
+                    , _swap()
+                {
+                }
+                Footprint(const Footprint& copy)
+                    : _id(copy._id)
+                    , _pss(copy._pss)
+                    , _privateClean(copy._privateClean)
+                    , _privateDirty(copy._privateDirty)
+                    , _swap(copy._swap)
+                {
+                }
+                ~Footprint()
+                {
+                }
+
+            public:
+                void Measure(const ProcessMemory::Rollup& rollup)
+                {
+                    _pss.Set(rollup.Pss);
+                    _privateClean.Set(rollup.PrivateClean);
+                    _privateDirty.Set(rollup.PrivateDirty);
+                    _swap.Set(rollup.Swap);
+                }
+                inline uint32_t Id() const
+                {
+                    return (_id);
+                }
+                inline const Core::MeasurementType<uint64_t>& Pss() const
+                {
+                    return (_pss);
+                }
+                inline const Core::MeasurementType<uint64_t>& PrivateClean() const
+                {
+                    return (_privateClean);
+                }
+                inline const Core::MeasurementType<uint64_t>& PrivateDirty() const
+                {
+                    return (_privateDirty);
+                }
+                inline const Core::MeasurementType<uint64_t>& Swap() const
+                {
+                    return (_swap);
+                }
+
+            private:
+                uint32_t _id;
+                Core::MeasurementType<uint64_t> _pss;
+                Core::MeasurementType<uint64_t> _privateClean;
+                Core::MeasurementType<uint64_t> _privateDirty;
+                Core::MeasurementType<uint64_t> _swap;
+            };
+
         public:
             MetaData()
                 : _resident()
                 , _allocated()
                 , _shared()
                 , _process()
+                , _cpu()
+                , _processes()
+                , _latency()
                 , _operational(false)
             {
             }
@@ -85,6 +228,9 @@ namespace Plugin {
                 , _allocated(copy._allocated)
                 , _shared(copy._shared)
                 , _process(copy._process)
+                , _cpu(copy._cpu)
+                , _processes(copy._processes)
+                , _latency(copy._latency)
                 , _operational(copy._operational)
             {
             }
@@ -93,23 +239,60 @@ namespace Plugin {
             }
 
         public:
-            void Measure(Exchange::IMemory* memInterface)
+            void Measure(const uint64_t resident, const uint64_t allocated, const uint64_t shared, const uint8_t processes)
+            {
+                _resident.Set(resident);
+                _allocated.Set(allocated);
+                _shared.Set(shared);
+                _process.Set(processes);
+            }
+            void Measure(const uint64_t cpu)
+            {
+                _cpu.Set(cpu);
+            }
+            // Processes that are gone are dropped, the ones that remain keep their statistics.
+            void Measure(const std::map<uint32_t, ProcessMemory::Rollup>& rollups)
             {
-                _resident.Set(memInterface->Resident());
-                _allocated.Set(memInterface->Allocated());
-                _shared.Set(memInterface->Shared());
-                _process.Set(memInterface->Processes());
+                std::list<Footprint> processes;
+                std::map<uint32_t, ProcessMemory::Rollup>::const_iterator index(rollups.begin());
+
+                while (index != rollups.end()) {
+                    std::list<Footprint>::iterator entry(_processes.begin());
+
+                    while ((entry != _processes.end()) && (entry->Id() != index->first)) {
+                        entry++;
+                    }
+
+                    if (entry != _processes.end()) {
+                        processes.splice(processes.end(), _processes, entry);
+                    } else {
+                        processes.emplace_back(index->first);
+                    }
+
+                    processes.back().Measure(index->second);
+                    index++;
+                }
+
+                _processes.swap(processes);
             }
             void Operational(const bool operational)
             {
                 _operational = operational;
             }
+            // Round-trip time of an operational probe, in microseconds.
+            void Latency(const uint64_t duration)
+            {
+                _latency.Add(duration);
+            }
             void Reset()
             {
                 _resident.Reset();
                 _allocated.Reset();
                 _shared.Reset();
                 _process.Reset();
+                _cpu.Reset();
+                _processes.clear();
+                _latency.Reset();
             }
 
         public:
@@ -129,6 +312,18 @@ namespace Plugin {
             {
                 return (_process);
             }
+            inline const Core::MeasurementType<uint64_t>& CPU() const
+            {
+                return (_cpu);
+            }
+            inline const std::list<Footprint>& Processes() const
+            {
+                return (_processes);
+            }
+            inline const LatencyHistogram& Latency() const
+            {
+                return (_latency);
+            }
             inline bool Operational() const
             {
                 return (_operational);
@@ -139,6 +334,9 @@ namespace Plugin {
             Core::MeasurementType<uint64_t> _allocated;
             Core::MeasurementType<uint64_t> _shared;
             Core::MeasurementType<uint8_t> _process;
+            Core::MeasurementType<uint64_t> _cpu; // Load in percent of a single core.
+            std::list<Footprint> _processes;
+            LatencyHistogram _latency;
             bool _operational;
         };
 
@@ -238,6 +436,168 @@ namespace Plugin {
                     Core::JSON::DecUInt64 Last;
                 };
 
+                class Footprint : public Core::JSON::Container {
+                public:
+                    Footprint()
+                        : Core::JSON::Container()
+                    {
+                        Add(_T("pid"), &Pid);
+                        Add(_T("pss"), &Pss);
+                        Add(_T("privateclean"), &PrivateClean);
+                        Add(_T("privatedirty"), &PrivateDirty);
+                        Add(_T("swap"), &Swap);
+                    }
+                    Footprint(const Monitor::MetaData::Footprint& input)
+                        : Core::JSON::Container()
+                        , Pss(input.Pss())
+                        , PrivateClean(input.PrivateClean())
+                        , PrivateDirty(input.PrivateDirty())
+                        , Swap(input.Swap())
+                    {
+                        Add(_T("pid"), &Pid);
+                        Add(_T("pss"), &Pss);
+                        Add(_T("privateclean"), &PrivateClean);
+                        Add(_T("privatedirty"), &PrivateDirty);
+                        Add(_T("swap"), &Swap);
+
+                        Pid = input.Id();
+                    }
+                    Footprint(const Footprint& copy)
+                        : Core::JSON::Container()
+                        , Pid(copy.Pid)
+                        , Pss(copy.Pss)
+                        , PrivateClean(copy.PrivateClean)
+                        , PrivateDirty(copy.PrivateDirty)
+                        , Swap(copy.Swap)
+                    {
+                        Add(_T("pid"), &Pid);
+                        Add(_T("pss"), &Pss);
+                        Add(_T("privateclean"), &PrivateClean);
+                        Add(_T("privatedirty"), &PrivateDirty);
+                        Add(_T("swap"), &Swap);
+                    }
+                    ~Footprint()
+                    {
+                    }
+
+                public:
+                    Footprint& operator=(const Footprint& RHS)
+                    {
+                        Pid = RHS.Pid;
+                        Pss = RHS.Pss;
+                        PrivateClean = RHS.PrivateClean;
+                        PrivateDirty = RHS.PrivateDirty;
+                        Swap = RHS.Swap;
+
+                        return (*this);
+                    }
+
+                public:
+                    Core::JSON::DecUInt32 Pid;
+                    Measurement Pss;
+                    Measurement PrivateClean;
+                    Measurement PrivateDirty;
+                    Measurement Swap;
+                };
+
+                class Histogram : public Core::JSON::Container {
+                public:
+                    class Bucket : public Core::JSON::Container {
+                    public:
+                        Bucket()
+                            : Core::JSON::Container()
+                        {
+                            Add(_T("le"), &Le);
+                            Add(_T("count"), &Count);
+                        }
+                        Bucket(const Bucket& copy)
+                            : Core::JSON::Container()
+                            , Le(copy.Le)
+                            , Count(copy.Count)
+                        {
+                            Add(_T("le"), &Le);
+                            Add(_T("count"), &Count);
+                        }
+                        ~Bucket()
+                        {
+                        }
+
+                    public:
+                        Bucket& operator=(const Bucket& RHS)
+                        {
+                            Le = RHS.Le;
+                            Count = RHS.Count;
+
+                            return (*this);
+                        }
+
+                    public:
+                        Core::JSON::DecUInt64 Le; // Upper bound in microseconds, absent for the last bucket.
+                        Core::JSON::DecUInt32 Count;
+                    };
+
+                public:
+                    Histogram()
+                        : Core::JSON::Container()
+                    {
+                        Add(_T("count"), &Count);
+                        Add(_T("sum"), &Sum);
+                        Add(_T("max"), &Max);
+                        Add(_T("buckets"), &Buckets);
+                    }
+                    Histogram(const Histogram& copy)
+                        : Core::JSON::Container()
+                        , Count(copy.Count)
+                        , Sum(copy.Sum)
+                        , Max(copy.Max)
+                        , Buckets(copy.Buckets)
+                    {
+                        Add(_T("count"), &Count);
+                        Add(_T("sum"), &Sum);
+                        Add(_T("max"), &Max);
+                        Add(_T("buckets"), &Buckets);
+                    }
+                    ~Histogram()
+                    {
+                    }
+
+                public:
+                    Histogram& operator=(const Histogram& RHS)
+                    {
+                        Count = RHS.Count;
+                        Sum = RHS.Sum;
+                        Max = RHS.Max;
+                        Buckets = RHS.Buckets;
+
+                        return (*this);
+                    }
+                    Histogram& operator=(const LatencyHistogram& RHS)
+                    {
+                        Count = RHS.Count();
+                        Sum = RHS.Sum();
+                        Max = RHS.Max();
+
+                        Buckets.Clear();
+
+                        for (uint8_t index = 0; index < LatencyHistogram::Buckets; index++) {
+                            Bucket& bucket(Buckets.Add());
+
+                            if ((index + 1) < LatencyHistogram::Buckets) {
+                                bucket.Le = LatencyHistogram::Bound(index);
+                            }
+                            bucket.Count = RHS.Count(index);
+                        }
+
+                        return (*this);
+                    }
+
+                public:
+                    Core::JSON::DecUInt32 Count;
+                    Core::JSON::DecUInt64 Sum; // Microseconds.
+                    Core::JSON::DecUInt64 Max; // Microseconds.
+                    Core::JSON::ArrayType<Bucket> Buckets;
+                };
+
             public:
                 MetaData()
                     : Core::JSON::Container()
@@ -245,6 +605,9 @@ namespace Plugin {
                     , Resident()
                     , Shared()
                     , Process()
+                    , CPU()
+                    , Processes()
+                    , Latency()
                     , Operational()
                     , Count()
                 {
@@ -252,6 +615,9 @@ namespace Plugin {
                     Add(_T("resident"), &Resident);
                     Add(_T("shared"), &Shared);
                     Add(_T("process"), &Process);
+                    Add(_T("cpu"), &CPU);
+                    Add(_T("processes"), &Processes);
+                    Add(_T("latency"), &Latency);
                     Add(_T("operational"), &Operational);
                     Add(_T("count"), &Count);
                 }
@@ -262,6 +628,9 @@ namespace Plugin {
                     Add(_T("resident"), &Resident);
                     Add(_T("shared"), &Shared);
                     Add(_T("process"), &Process);
+                    Add(_T("cpu"), &CPU);
+                    Add(_T("processes"), &Processes);
+                    Add(_T("latency"), &Latency);
                     Add(_T("operational"), &Operational);
                     Add(_T("count"), &Count);
 
@@ -269,8 +638,12 @@ namespace Plugin {
                     Resident = input.Resident();
                     Shared = input.Shared();
                     Process = input.Process();
+                    CPU = input.CPU();
                     Operational = input.Operational();
                     Count = input.Allocated().Measurements();
+                    Latency = input.Latency();
+
+                    Breakdown(input.Processes());
                 }
                 MetaData(const MetaData& copy)
                     : Core::JSON::Container()
@@ -278,6 +651,9 @@ namespace Plugin {
                     , Resident(copy.Resident)
                     , Shared(copy.Shared)
                     , Process(copy.Process)
+                    , CPU(copy.CPU)
+                    , Processes(copy.Processes)
+                    , Latency(copy.Latency)
                     , Operational(copy.Operational)
                     , Count(copy.Count)
                 {
@@ -285,6 +661,9 @@ namespace Plugin {
                     Add(_T("resident"), &Resident);
                     Add(_T("shared"), &Shared);
                     Add(_T("process"), &Process);
+                    Add(_T("cpu"), &CPU);
+                    Add(_T("processes"), &Processes);
+                    Add(_T("latency"), &Latency);
                     Add(_T("operational"), &Operational);
                     Add(_T("count"), &Count);
                 }
@@ -298,6 +677,9 @@ namespace Plugin {
                     Resident = RHS.Resident;
                     Shared = RHS.Shared;
                     Process = RHS.Process;
+                    CPU = RHS.CPU;
+                    Processes = RHS.Processes;
+                    Latency = RHS.Latency;
                     Operational = RHS.Operational;
                     Count = RHS.Count;
 
@@ -309,21 +691,164 @@ namespace Plugin {
                     Resident = RHS.Resident();
                     Shared = RHS.Shared();
                     Process = RHS.Process();
+                    CPU = RHS.CPU();
                     Operational = RHS.Operational();
                     Count = RHS.Allocated().Measurements();
+                    Latency = RHS.Latency();
+
+                    Processes.Clear();
+                    Breakdown(RHS.Processes());
 
                     return (*this);
                 }
 
+            private:
+                void Breakdown(const std::list<Monitor::MetaData::Footprint>& processes)
+                {
+                    std::list<Monitor::MetaData::Footprint>::const_iterator index(processes.begin());
+
+                    while (index != processes.end()) {
+                        Processes.Add(Footprint(*index));
+                        index++;
+                    }
+                }
+
             public:
                 Measurement Allocated;
                 Measurement Resident;
                 Measurement Shared;
                 Measurement Process;
+                Measurement CPU;
+                Core::JSON::ArrayType<Footprint> Processes;
+                Histogram Latency;
                 Core::JSON::Boolean Operational;
                 Core::JSON::DecUInt32 Count;
             };
 
+            class Sample : public Core::JSON::Container {
+            public:
+                Sample()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("time"), &Time);
+                    Add(_T("resident"), &Resident);
+                    Add(_T("peakresident"), &PeakResident);
+                    Add(_T("allocated"), &Allocated);
+                    Add(_T("shared"), &Shared);
+                    Add(_T("process"), &Process);
+                    Add(_T("cpu"), &CPU);
+                    Add(_T("peakcpu"), &PeakCPU);
+                }
+                Sample(const MeasurementHistory::Sample& input)
+                    : Core::JSON::Container()
+                {
+                    Add(_T("time"), &Time);
+                    Add(_T("resident"), &Resident);
+                    Add(_T("peakresident"), &PeakResident);
+                    Add(_T("allocated"), &Allocated);
+                    Add(_T("shared"), &Shared);
+                    Add(_T("process"), &Process);
+                    Add(_T("cpu"), &CPU);
+                    Add(_T("peakcpu"), &PeakCPU);
+
+                    Time = input.Time / (1000 * 1000);
+                    Resident = input.Resident;
+                    PeakResident = input.PeakResident;
+                    Allocated = input.Allocated;
+                    Shared = input.Shared;
+                    Process = input.Process;
+                    CPU = input.CPU;
+                    PeakCPU = input.PeakCPU;
+                }
+                Sample(const Sample& copy)
+                    : Core::JSON::Container()
+                    , Time(copy.Time)
+                    , Resident(copy.Resident)
+                    , PeakResident(copy.PeakResident)
+                    , Allocated(copy.Allocated)
+                    , Shared(copy.Shared)
+                    , Process(copy.Process)
+                    , CPU(copy.CPU)
+                    , PeakCPU(copy.PeakCPU)
+                {
+                    Add(_T("time"), &Time);
+                    Add(_T("resident"), &Resident);
+                    Add(_T("peakresident"), &PeakResident);
+                    Add(_T("allocated"), &Allocated);
+                    Add(_T("shared"), &Shared);
+                    Add(_T("process"), &Process);
+                    Add(_T("cpu"), &CPU);
+                    Add(_T("peakcpu"), &PeakCPU);
+                }
+                ~Sample()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt64 Time; // Seconds since the epoch.
+                Core::JSON::DecUInt64 Resident;
+                Core::JSON::DecUInt64 PeakResident;
+                Core::JSON::DecUInt64 Allocated;
+                Core::JSON::DecUInt64 Shared;
+                Core::JSON::DecUInt8 Process;
+                Core::JSON::DecUInt32 CPU;
+                Core::JSON::DecUInt32 PeakCPU;
+            };
+
+            class Range : public Core::JSON::Container {
+            private:
+                Range(const Range&) = delete;
+                Range& operator=(const Range&) = delete;
+
+            public:
+                Range()
+                    : Core::JSON::Container()
+                    , Callsign()
+                    , From(0)
+                    , To(~0)
+                    , Resolution(MeasurementHistory::AUTO)
+                {
+                    Add(_T("callsign"), &Callsign);
+                    Add(_T("from"), &From);
+                    Add(_T("to"), &To);
+                    Add(_T("resolution"), &Resolution);
+                }
+                ~Range()
+                {
+                }
+
+            public:
+                Core::JSON::String Callsign;
+                Core::JSON::DecUInt64 From; // Seconds since the epoch.
+                Core::JSON::DecUInt64 To; // Seconds since the epoch.
+                Core::JSON::EnumType<MeasurementHistory::resolution> Resolution;
+            };
+
+            class History : public Core::JSON::Container {
+            private:
+                History(const History&) = delete;
+                History& operator=(const History&) = delete;
+
+            public:
+                History()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("callsign"), &Callsign);
+                    Add(_T("resolution"), &Resolution);
+                    Add(_T("period"), &Period);
+                    Add(_T("samples"), &Samples);
+                }
+                ~History()
+                {
+                }
+
+            public:
+                Core::JSON::String Callsign;
+                Core::JSON::EnumType<MeasurementHistory::resolution> Resolution;
+                Core::JSON::DecUInt32 Period; // Seconds covered by a sample, 0 for the raw measurements.
+                Core::JSON::ArrayType<Sample> Samples;
+            };
+
         private:
             Data& operator=(const Data&);
 
@@ -399,22 +924,34 @@ namespace Plugin {
                     Add(_T("callsign"), &Callsign);
                     Add(_T("memory"), &MetaData);
                     Add(_T("memorylimit"), &MetaDataLimit);
+                    Add(_T("cpulimit"), &CPULimit);
                     Add(_T("operational"), &Operational);
+                    Add(_T("latency"), &Latency);
                     Add(_T("restart"), &Restart);
+                    Add(_T("history"), &History);
+                    Add(_T("leak"), &Leak);
                 }
                 Entry(const Entry& copy)
                     : Core::JSON::Container()
                     , Callsign(copy.Callsign)
                     , MetaData(copy.MetaData)
                     , MetaDataLimit(copy.MetaDataLimit)
+                    , CPULimit(copy.CPULimit)
                     , Operational(copy.Operational)
+                    , Latency(copy.Latency)
                     , Restart(copy.Restart)
+                    , History(copy.History)
+                    , Leak(copy.Leak)
                 {
                     Add(_T("callsign"), &Callsign);
                     Add(_T("memory"), &MetaData);
                     Add(_T("memorylimit"), &MetaDataLimit);
+                    Add(_T("cpulimit"), &CPULimit);
                     Add(_T("operational"), &Operational);
+                    Add(_T("latency"), &Latency);
                     Add(_T("restart"), &Restart);
+                    Add(_T("history"), &History);
+                    Add(_T("leak"), &Leak);
                 }
                 ~Entry()
                 {
@@ -424,8 +961,38 @@ namespace Plugin {
                 Core::JSON::String Callsign;
                 Core::JSON::DecUInt32 MetaData;
                 Core::JSON::DecUInt32 MetaDataLimit;
+                Core::JSON::DecUInt32 CPULimit; // Percent of a single core, measured at the memory interval.
                 Core::JSON::DecSInt32 Operational;
+                Core::JSON::DecUInt32 Latency; // Milliseconds an operational probe may take before it counts as not operational, 0 is off.
                 RestartInfo Restart;
+                HistoryInfo History;
+                LeakInfo Leak;
+            };
+
+            class PressureInfo : public Core::JSON::Container {
+            private:
+                PressureInfo(const PressureInfo&) = delete;
+                PressureInfo& operator=(const PressureInfo&) = delete;
+
+            public:
+                PressureInfo()
+                    : Core::JSON::Container()
+                    , Stall(150)
+                    , Window(1000)
+                    , Stretch(6)
+                {
+                    Add(_T("stall"), &Stall);
+                    Add(_T("window"), &Window);
+                    Add(_T("stretch"), &Stretch);
+                }
+                ~PressureInfo()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Stall; // Milliseconds stalled on memory within the window, to trigger a measurement.
+                Core::JSON::DecUInt32 Window; // Milliseconds.
+                Core::JSON::DecUInt8 Stretch; // Factor applied to the memory intervals, as pressure triggers a measurement anyway.
             };
 
         public:
@@ -433,6 +1000,7 @@ namespace Plugin {
                 : Core::JSON::Container()
             {
                 Add(_T("observables"), &Observables);
+                Add(_T("pressure"), &Pressure);
             }
             ~Config()
             {
@@ -440,13 +1008,16 @@ namespace Plugin {
 
         public:
             Core::JSON::ArrayType<Entry> Observables;
+            PressureInfo Pressure;
         };
 
-        class MonitorObjects : public PluginHost::IPlugin::INotification {
+        class MonitorObjects : public PluginHost::IPlugin::INotification, public MemoryPressure::ICallback {
         private:
             MonitorObjects(const MonitorObjects&) = delete;
             MonitorObjects& operator=(const MonitorObjects&) = delete;
 
+            static constexpr uint32_t TickTime = 100 * 1000; // Resolution of the scheduling, in microseconds.
+
         public:
             class Job : public Core::IDispatchType<void> {
             private:
@@ -474,6 +1045,32 @@ namespace Plugin {
                 MonitorObjects& _parent;
             };
 
+            class PressureJob : public Core::IDispatchType<void> {
+            private:
+                PressureJob() = delete;
+                PressureJob(const PressureJob& copy) = delete;
+                PressureJob& operator=(const PressureJob& RHS) = delete;
+
+            public:
+                PressureJob(MonitorObjects* parent)
+                    : _parent(*parent)
+                {
+                    ASSERT(parent != nullptr);
+                }
+                virtual ~PressureJob()
+                {
+                }
+
+            public:
+                virtual void Dispatch() override
+                {
+                    _parent.Pressured();
+                }
+
+            private:
+                MonitorObjects& _parent;
+            };
+
             class MonitorObject {
             public:
                 MonitorObject() = delete;
@@ -482,7 +1079,9 @@ namespace Plugin {
                 enum evaluation {
                     SUCCESFULL = 0x00,
                     NOT_OPERATIONAL = 0x01,
-                    EXCEEDED_MEMORY = 0x02
+                    EXCEEDED_MEMORY = 0x02,
+                    EXCEEDED_CPU = 0x04,
+                    LEAK_SUSPECTED = 0x08
                 };
 
                 typedef struct {
@@ -492,18 +1091,25 @@ namespace Plugin {
 
             public:
                 MonitorObject(
+                    const string& callsign,
                     const bool actOnOperational,
                     const uint32_t operationalInterval,
                     const uint32_t memoryInterval,
                     const uint64_t memoryThreshold,
+                    const uint32_t cpuThreshold,
+                    const uint64_t latencyThreshold,
                     const uint64_t absTime,
                     const uint16_t operationalRestartWindow,
                     const uint8_t operationalRestartLimit,
                     const uint16_t memoryRestartWindow,
-                    const uint8_t memoryRestartLimit)
+                    const uint8_t memoryRestartLimit,
+                    const HistoryInfo& history,
+                    const LeakInfo& leak)
                     : _operationalInterval(operationalInterval)
                     , _memoryInterval(memoryInterval)
                     , _memoryThreshold(memoryThreshold * 1024)
+                    , _cpuThreshold(cpuThreshold)
+                    , _latencyThreshold(latencyThreshold)
                     , _operationalSlots(operationalInterval)
                     , _memorySlots(memoryInterval)
                     , _nextSlot(absTime)
@@ -515,7 +1121,15 @@ namespace Plugin {
                     , _operationalRestartLimit(operationalRestartLimit)
                     , _memoryRestartWindow(memoryRestartWindow)
                     , _memoryRestartLimit(memoryRestartLimit)
+                    , _operationalRestarts(0)
+                    , _memoryRestarts(0)
                     , _measurement()
+                    , _usage(callsign)
+                    , _history(history.Samples.Value(), history.Minutes.Value(), history.Hours.Value())
+                    , _leak(leak.Window.Value())
+                    , _leakHorizon(leak.Horizon.Value())
+                    , _leakQuiet(leak.Quiet.Value())
+                    , _watched(0)
                     , _operationalEvaluate(actOnOperational)
                     , _source(nullptr)
                 {
@@ -526,11 +1140,15 @@ namespace Plugin {
                     } else {
                         _interval = (_operationalInterval == 0 ? _memoryInterval : _operationalInterval);
                     }
+
+                    _nextSlot += Phase(callsign, _interval);
                 }
                 MonitorObject(const MonitorObject& copy)
                     : _operationalInterval(copy._operationalInterval)
                     , _memoryInterval(copy._memoryInterval)
                     , _memoryThreshold(copy._memoryThreshold)
+                    , _cpuThreshold(copy._cpuThreshold)
+                    , _latencyThreshold(copy._latencyThreshold)
                     , _operationalSlots(copy._operationalSlots)
                     , _memorySlots(copy._memorySlots)
                     , _nextSlot(copy._nextSlot)
@@ -542,7 +1160,15 @@ namespace Plugin {
                     , _operationalRestartLimit(copy._operationalRestartLimit)
                     , _memoryRestartWindow(copy._memoryRestartWindow)
                     , _memoryRestartLimit(copy._memoryRestartLimit)
+                    , _operationalRestarts(copy._operationalRestarts)
+                    , _memoryRestarts(copy._memoryRestarts)
                     , _measurement(copy._measurement)
+                    , _usage(copy._usage)
+                    , _history(copy._history)
+                    , _leak(copy._leak)
+                    , _leakHorizon(copy._leakHorizon)
+                    , _leakQuiet(copy._leakQuiet)
+                    , _watched(copy._watched)
                     , _operationalEvaluate(copy._operationalEvaluate)
                     , _source(copy._source)
                     , _interval(copy._interval)
@@ -594,6 +1220,10 @@ namespace Plugin {
 
                     if (result == false) {
                         *restartCount = 0;
+                    } else if (why == PluginHost::IShell::MEMORY_EXCEEDED) {
+                        _memoryRestarts++;
+                    } else {
+                        _operationalRestarts++;
                     }
 
                     return result;
@@ -621,6 +1251,11 @@ namespace Plugin {
                     _memoryRestartWindow = memoryRestartWindow;
                     _memoryRestartLimit = memoryRestartLimit;
                 }
+                // Restarts done since the monitor started, never reset.
+                inline uint32_t Restarts(PluginHost::IShell::reason why) const
+                {
+                    return (why == PluginHost::IShell::MEMORY_EXCEEDED ? _memoryRestarts : _operationalRestarts);
+                }
                 inline bool HasRestartAllowed() const
                 {
                     return (_operationalEvaluate);
@@ -633,6 +1268,10 @@ namespace Plugin {
                 {
                     return (_measurement);
                 }
+                inline const MeasurementHistory& History() const
+                {
+                    return (_history);
+                }
                 inline bool HasMeasurement() const
                 {
                     return (((_measurement.Allocated().Min() == Core::NumberType<uint64_t>::Max()) &&
@@ -648,10 +1287,11 @@ namespace Plugin {
                 }
                 inline void Retrigger(uint64_t currentSlot)
                 {
-                    while (_nextSlot < currentSlot) {
+                    while (_nextSlot <= currentSlot) {
                         _nextSlot += _interval;
                     }
                 }
+                // An evaluation uses the source and the usage, so this is called with the observation locked.
                 inline void Set(Exchange::IMemory* memory)
                 {
                     if (_source != nullptr) {
@@ -664,9 +1304,15 @@ namespace Plugin {
                         _source->AddRef();
                     }
 
+                    // Whatever process we were looking at, it is no longer the one to look at.
+                    _usage.Reset();
+                    _leak.Reset();
+
                     _measurement.Operational(_source != nullptr);
                 }
-                inline uint32_t Evaluate()
+                // The lock is the one readers of the measurement take, the probes and measurements themselves
+                // run without it, only storing the results is done with it.
+                inline uint32_t Evaluate(Core::CriticalSection& lock)
                 {
                     uint32_t status(SUCCESFULL);
                     if (_source != nullptr) {
@@ -674,8 +1320,18 @@ namespace Plugin {
                         _memorySlots -= _interval;
 
                         if ((_operationalInterval != 0) && (_operationalSlots == 0)) {
+                            uint64_t start = Core::Time::Now().Ticks();
                             bool operational = _source->IsOperational();
+                            uint64_t duration = Core::Time::Now().Ticks() - start;
+                            if ((operational == true) && (_latencyThreshold != 0) && (duration > _latencyThreshold)) {
+                                // Alive, but too slow to be of any use.
+                                operational = false;
+                                TRACE_L1("Status operational probe took %llu us. %d", static_cast<unsigned long long>(duration), __LINE__);
+                            }
+                            lock.Lock();
+                            _measurement.Latency(duration);
                             _measurement.Operational(operational);
+                            lock.Unlock();
                             if (operational == false) {
                                 status |= NOT_OPERATIONAL;
                                 TRACE_L1("Status not operational. %d", __LINE__);
@@ -683,22 +1339,129 @@ namespace Plugin {
                             _operationalSlots = _operationalInterval;
                         }
                         if ((_memoryInterval != 0) && (_memorySlots == 0)) {
-                            _measurement.Measure(_source);
+                            status |= Measure(lock);
+                            _memorySlots = _memoryInterval;
+                        }
+                    }
+                    return (status);
+                }
+                // Takes a memory (and CPU) measurement, either on its interval or because of memory pressure.
+                uint32_t Measure(Core::CriticalSection& lock)
+                {
+                    uint32_t status(SUCCESFULL);
+
+                    if (_source != nullptr) {
+                        // Asking the source may take a while, it is done before the lock is taken.
+                        const uint64_t resident(_source->Resident());
+                        const uint64_t allocated(_source->Allocated());
+                        const uint64_t shared(_source->Shared());
+                        const uint8_t processes(_source->Processes());
+
+                        lock.Lock();
+                        _measurement.Measure(resident, allocated, shared, processes);
+                        lock.Unlock();
+
+                        if ((_memoryThreshold != 0) && (_measurement.Resident().Last() > _memoryThreshold)) {
+                            status |= EXCEEDED_MEMORY;
+                            TRACE_L1("Status MetaData Exceeded. %d", __LINE__);
+                        }
+
+                        uint64_t now = Core::Time::Now().Ticks();
+                        uint64_t load = 0;
+                        bool loaded = _usage.Measure(load);
 
-                            if ((_memoryThreshold != 0) && (_measurement.Resident().Last() > _memoryThreshold)) {
-                                status |= EXCEEDED_MEMORY;
-                                TRACE_L1("Status MetaData Exceeded. %d", __LINE__);
+                        if (loaded == true) {
+                            lock.Lock();
+                            _measurement.Measure(load);
+                            lock.Unlock();
+
+                            if ((_cpuThreshold != 0) && (load > _cpuThreshold)) {
+                                status |= EXCEEDED_CPU;
+                                TRACE_L1("Status CPU Exceeded. %d", __LINE__);
                             }
-                            _memorySlots = _memoryInterval;
                         }
+
+                        // The breakdown per process, the same pages are not counted for every process sharing them.
+                        std::list<uint32_t> pids;
+                        std::map<uint32_t, ProcessMemory::Rollup> rollups;
+
+                        _usage.Processes(pids);
+
+                        std::list<uint32_t>::const_iterator pid(pids.begin());
+
+                        while (pid != pids.end()) {
+                            ProcessMemory::Rollup rollup;
+
+                            if (ProcessMemory::Read(*pid, rollup) == true) {
+                                rollups.insert(std::pair<uint32_t, ProcessMemory::Rollup>(*pid, rollup));
+                            }
+                            pid++;
+                        }
+
+                        // Readers walk the list of processes, it must not be swapped under their feet.
+                        lock.Lock();
+                        _measurement.Measure(rollups);
+                        lock.Unlock();
+
+                        if ((_memoryThreshold != 0) && (_leakHorizon != 0)) {
+                            uint64_t remaining;
+
+                            _leak.Add(now, _measurement.Resident().Last());
+
+                            if ((_leak.Remaining(_memoryThreshold, remaining) == true) && (remaining < _leakHorizon)) {
+                                // Restart while it is quiet, unless the threshold is getting too close to wait any longer.
+                                if ((loaded == false) || (load <= _leakQuiet) || (remaining < (_leakHorizon / 4))) {
+                                    status |= LEAK_SUSPECTED;
+                                    TRACE_L1("Status Leak Suspected, threshold reached in %llu seconds. %d", static_cast<unsigned long long>(remaining), __LINE__);
+                                }
+                            }
+                        }
+
+                        lock.Lock();
+                        _history.Add(now,
+                            _measurement.Resident().Last(),
+                            _measurement.Allocated().Last(),
+                            _measurement.Shared().Last(),
+                            _measurement.Process().Last(),
+                            static_cast<uint32_t>(load));
+                        lock.Unlock();
                     }
                     return (status);
                 }
+                // The host process, but only once after it changed.
+                inline uint32_t NewProcess()
+                {
+                    uint32_t result = 0;
+
+                    if (_usage.Id() != _watched) {
+                        _watched = _usage.Id();
+                        result = _watched;
+                    }
+
+                    return (result);
+                }
+
+            private:
+                // Observables with the same interval should not all be measured at the same moment. The offset
+                // within the interval is derived from the callsign (FNV-1a), so it is the same on every start.
+                static uint32_t Phase(const string& callsign, const uint32_t interval)
+                {
+                    uint32_t hash = 2166136261;
+
+                    for (string::const_iterator index(callsign.begin()); index != callsign.end(); index++) {
+                        hash = (hash ^ static_cast<uint8_t>(*index)) * 16777619;
+                    }
+
+                    // Whole milliseconds, the interval is in microseconds.
+                    return (interval >= 1000 ? (hash % (interval / 1000)) * 1000 : 0);
+                }
 
             private:
                 const uint32_t _operationalInterval; //!< Interval (s) to check the monitored processes
                 const uint32_t _memoryInterval; //!<  Interval (s) for a memory measurement.
                 const uint64_t _memoryThreshold; //!< MetaData threshold in bytes for all processes.
+                const uint32_t _cpuThreshold; //!< CPU threshold in percent of a single core for all processes.
+                const uint64_t _latencyThreshold; //!< Time (us) an operational probe may take, before it counts as not operational.
                 uint32_t _operationalSlots;
                 uint32_t _memorySlots;
                 uint64_t _nextSlot;
@@ -710,20 +1473,102 @@ namespace Plugin {
                 uint8_t _operationalRestartLimit;
                 uint16_t _memoryRestartWindow;
                 uint8_t _memoryRestartLimit;
+                uint32_t _operationalRestarts;
+                uint32_t _memoryRestarts;
                 MetaData _measurement;
+                ProcessUsage _usage;
+                MeasurementHistory _history;
+                LeakDetector _leak;
+                const uint32_t _leakHorizon; //!< Seconds ahead a predicted memory threshold crossing triggers a restart.
+                const uint8_t _leakQuiet; //!< CPU load in percent below which the plugin is considered quiet.
+                uint32_t _watched; //!< Host process of which the cgroup is watched for memory pressure.
                 bool _operationalEvaluate;
                 Exchange::IMemory* _source;
                 uint32_t _interval; //!< The lowest possible interval to check both memory and processes.
             };
 
+            // Evaluates a single observable on the worker pool, so different observables are evaluated in parallel.
+            class Observation : public Core::IDispatchType<void> {
+            private:
+                Observation() = delete;
+                Observation(const Observation& copy) = delete;
+                Observation& operator=(const Observation& RHS) = delete;
+
+            public:
+                Observation(MonitorObjects* parent, const string& callsign, MonitorObject* object)
+                    : _parent(*parent)
+                    , _callsign(callsign)
+                    , _object(*object)
+                    , _lock()
+                    , _pending(false)
+                {
+                    ASSERT(parent != nullptr);
+                    ASSERT(object != nullptr);
+                }
+                virtual ~Observation()
+                {
+                }
+
+            public:
+                inline const string& Callsign() const
+                {
+                    return (_callsign);
+                }
+                inline MonitorObject& Object()
+                {
+                    return (_object);
+                }
+                inline void Lock() const
+                {
+                    _lock.Lock();
+                }
+                inline void Unlock() const
+                {
+                    _lock.Unlock();
+                }
+                // Returns false if the previous evaluation is still waiting for a worker, or still running. A
+                // probe that hangs then only holds up its own observable, not another worker every interval.
+                inline bool Submit()
+                {
+                    return (_pending.exchange(true) == false);
+                }
+                inline void Done()
+                {
+                    _pending = false;
+                }
+                virtual void Dispatch() override
+                {
+                    _parent.Evaluate(*this);
+                    Done();
+                }
+
+            private:
+                MonitorObjects& _parent;
+                const string _callsign;
+                MonitorObject& _object;
+                mutable Core::CriticalSection _lock;
+                std::atomic<bool> _pending;
+            };
+
         public:
 #ifdef __WIN32__
 #pragma warning(disable : 4355)
 #endif
             MonitorObjects(Monitor* parent)
                 : _adminLock()
+                , _probeLock()
                 , _monitor()
+                , _observations()
+                , _wheel(TickTime)
+                , _tickLoad()
+                , _overruns(0)
                 , _job(Core::ProxyType<Job>::Create(this))
+                , _pressureJob(Core::ProxyType<PressureJob>::Create(this))
+                , _pressure(nullptr)
+                , _pressured(false)
+                , _measured(0)
+                , _rendered(static_cast<uint32_t>(~0))
+                , _metrics()
                 , _service(nullptr)
                 , _parent(*parent)
             {
@@ -756,26 +1601,37 @@ namespace Plugin {
                         operationalRestartInterval,
                         memoryRestartWindow,
                         memoryRestartInterval);
+                    _measured++;
                 }
             }
-            inline void Open(PluginHost::IShell* service, Core::JSON::ArrayType<Config::Entry>::Iterator& index)
+            inline void Open(PluginHost::IShell* service, Core::JSON::ArrayType<Config::Entry>::Iterator& index, const Config::PressureInfo& pressure)
             {
                 ASSERT((service != nullptr) && (_service == nullptr));
 
                 uint64_t baseTime = Core::Time::Now().Ticks();
+                uint8_t stretch = 1;
 
                 _service = service;
                 _service->AddRef();
 
+                if (pressure.IsSet() == true) {
+                    _pressure = new MemoryPressure(this, pressure.Stall.Value(), pressure.Window.Value());
+
+                    if ((_pressure->IsValid() == true) && (pressure.Stretch.Value() > 1)) {
+                        // Memory pressure triggers a measurement pass right away, so the periodic ones can be far apart.
+                        stretch = pressure.Stretch.Value();
+                    }
+                }
+
                 _adminLock.Lock();
 
                 while (index.Next() == true) {
                     Config::Entry& element(index.Current());
                     string callSign(element.Callsign.Value());
                     uint64_t memoryThreshold(element.MetaDataLimit.Value());
-                    uint32_t interval = abs(element.Operational.Value());
-                    interval = interval * 1000 * 1000; // Move from Seconds to MicroSecond
-                    uint32_t memory(element.MetaData.Value() * 1000 * 1000); // Move from Seconds to MicroSeconds
+                    uint32_t cpuThreshold(element.CPULimit.Value());
+                    uint32_t interval = MicroSeconds(static_cast<uint64_t>(std::abs(static_cast<int64_t>(element.Operational.Value()))));
+                    uint32_t memory = MicroSeconds(static_cast<uint64_t>(element.MetaData.Value()) * stretch);
                     uint16_t operationalWindow = 0;
                     uint8_t operationalLimit = 0;
                     uint16_t memoryWindow = 0;
@@ -793,18 +1649,34 @@ namespace Plugin {
                     if ((interval != 0) || (memory != 0)) {
                         _monitor.insert(
                             std::pair<string, MonitorObject>(callSign, MonitorObject(
+								callSign,
 								element.Operational.Value() >= 0, 
 								interval, 
 								memory, 
 								memoryThreshold, 
+								cpuThreshold,
+								static_cast<uint64_t>(element.Latency.Value()) * 1000,
 								baseTime, 
 								operationalWindow, 
 								operationalLimit, 
 								memoryWindow, 
-								memoryLimit)));
+								memoryLimit,
+								element.History,
+								element.Leak)));
                     }
                 }
 
+                std::vector<uint32_t> due;
+                std::map<string, MonitorObject>::iterator entry(_monitor.begin());
+
+                _wheel.Advance(baseTime, due);
+
+                while (entry != _monitor.end()) {
+                    _wheel.Insert(entry->second.TimeSlot(), static_cast<uint32_t>(_observations.size()));
+                    _observations.push_back(Core::ProxyType<Observation>::Create(this, entry->first, &(entry->second)));
+                    entry++;
+                }
+
                 _adminLock.Unlock();
 
                 PluginHost::WorkerPool::Instance().Submit(_job);
@@ -813,9 +1685,31 @@ namespace Plugin {
             {
                 ASSERT(_service != nullptr);
 
+                // First make sure no pressure is reported anymore, before revoking the jobs it might submit.
+                _probeLock.Lock();
+                if (_pressure != nullptr) {
+                    delete _pressure;
+                    _pressure = nullptr;
+                }
+                _probeLock.Unlock();
+
+                PluginHost::WorkerPool::Instance().Revoke(_pressureJob);
                 PluginHost::WorkerPool::Instance().Revoke(_job);
 
+                // A revoked pressure job never cleared the flag, without this a next Open would never see pressure again.
+                _pressured = false;
+
+                // The Probe is gone, so nothing submits the observations anymore.
+                std::vector<Core::ProxyType<Observation>>::iterator observation(_observations.begin());
+
+                while (observation != _observations.end()) {
+                    PluginHost::WorkerPool::Instance().Revoke(Core::ProxyType<Core::IDispatchType<void>>(*observation));
+                    observation++;
+                }
+
                 _adminLock.Lock();
+                _wheel.Clear();
+                _observations.clear();
                 _monitor.clear();
                 _adminLock.Unlock();
                 _service->Release();
@@ -823,6 +1717,16 @@ namespace Plugin {
             }
             virtual void StateChange(PluginHost::IShell* service)
             {
+                // A worker may be evaluating this observable, its source and process are only replaced under
+                // the lock of the observation. That lock is taken before the admin lock, as Evaluate() does.
+                _adminLock.Lock();
+                Core::ProxyType<Observation> observation(Observing(service->Callsign()));
+                _adminLock.Unlock();
+
+                if (observation.IsValid() == true) {
+                    observation->Lock();
+                }
+
                 _adminLock.Lock();
 
                 std::map<string, MonitorObject>::iterator index(_monitor.find(service->Callsign()));
@@ -856,9 +1760,15 @@ namespace Plugin {
                             PluginHost::WorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(service, PluginHost::IShell::ACTIVATED, PluginHost::IShell::AUTOMATIC));
                         }
                     }
+
+                    _measured++;
                 }
 
                 _adminLock.Unlock();
+
+                if (observation.IsValid() == true) {
+                    observation->Unlock();
+                }
             }
             void Snapshot(Core::JSON::ArrayType<Monitor::Data>& snapshot)
             {
@@ -896,6 +1806,53 @@ namespace Plugin {
                 return (found);
             }
 
+            bool History(const string& name, const uint64_t from, const uint64_t to, const MeasurementHistory::resolution resolution, Monitor::Data::History& result)
+            {
+                bool found = false;
+
+                _adminLock.Lock();
+
+                std::map<string, MonitorObject>::iterator index(_monitor.find(name));
+
+                if (index != _monitor.end()) {
+                    // The history works with microseconds, the outside world with seconds.
+                    MeasurementHistory::resolution used = index->second.History().Range(
+                        from * 1000 * 1000,
+                        (to >= (static_cast<uint64_t>(~0) / (1000 * 1000)) ? static_cast<uint64_t>(~0) : ((to + 1) * 1000 * 1000) - 1),
+                        resolution,
+                        [&result](const MeasurementHistory::Sample& sample) {
+                            result.Samples.Add(Monitor::Data::Sample(sample));
+                        });
+
+                    result.Callsign = name;
+                    result.Resolution = used;
+                    result.Period = static_cast<uint32_t>(MeasurementHistory::Period(used));
+                    found = true;
+                }
+
+                _adminLock.Unlock();
+
+                return (found);
+            }
+
+            // Rendering is only done if something changed since the previous scrape, otherwise it is a copy.
+            void Metrics(string& text)
+            {
+                _adminLock.Lock();
+
+                uint32_t measured(_measured.load());
+
+                if (measured != _rendered) {
+                    // Anything landing while rendering bumps the counter again and is picked up next time.
+                    _rendered = measured;
+                    Render(_metrics);
+                }
+
+                text = _metrics;
+
+                _adminLock.Unlock();
+            }
+
             void Snapshot(const string& callsign, Core::JSON::ArrayType<JsonData::Monitor::InfoInfo>* response)
             {
                 _adminLock.Lock();
@@ -950,6 +1907,7 @@ namespace Plugin {
                 if (index != _monitor.end()) {
                     result = index->second.Measurement();
                     index->second.Reset();
+                    _measured++;
                     found = true;
                 }
 
@@ -968,6 +1926,7 @@ namespace Plugin {
 
                 if (index != _monitor.end()) {
                     index->second.Reset();
+                    _measured++;
                     found = true;
                 }
 
@@ -976,62 +1935,272 @@ namespace Plugin {
                 return (found);
             }
 
+            // Called from the resource monitor, keep it short and never block here.
+            virtual void Pressure() override
+            {
+                if (_pressured.exchange(true) == false) {
+                    PluginHost::WorkerPool::Instance().Submit(_pressureJob);
+                }
+            }
+
             BEGIN_INTERFACE_MAP(MonitorObjects)
             INTERFACE_ENTRY(PluginHost::IPlugin::INotification)
             END_INTERFACE_MAP
 
         private:
+            // Move from Seconds to MicroSeconds, intervals that do not fit are as long as they can be.
+            static uint32_t MicroSeconds(const uint64_t seconds)
+            {
+                return (static_cast<uint32_t>(std::min(seconds * 1000 * 1000, static_cast<uint64_t>(static_cast<uint32_t>(~0)))));
+            }
             // Probe can be run in an unlocked state as the destruction of the observer list
             // is always done if the thread that calls the Probe is blocked (paused)
+            // It only turns the wheel, the observables that are due are evaluated by their own job.
             void Probe()
             {
                 uint64_t scheduledTime(Core::Time::Now().Ticks());
-                uint64_t nextSlot(static_cast<uint64_t>(~0));
+                std::vector<uint32_t> due;
 
-                std::map<string, MonitorObject>::iterator index(_monitor.begin());
+                _wheel.Advance(scheduledTime, due);
 
-                // Go through the list of pending observations...
-                while (index != _monitor.end()) {
-                    MonitorObject& info(index->second);
+                if (due.empty() == false) {
+                    std::vector<uint32_t>::const_iterator index(due.begin());
 
-                    if (info.TimeSlot() <= scheduledTime) {
-                        uint32_t value(info.Evaluate());
+                    _adminLock.Lock();
+                    _tickLoad.Set(static_cast<uint32_t>(due.size()));
+                    _adminLock.Unlock();
 
-                        if ((value & (MonitorObject::NOT_OPERATIONAL | MonitorObject::EXCEEDED_MEMORY)) != 0) {
-                            PluginHost::IShell* plugin(_service->QueryInterfaceByCallsign<PluginHost::IShell>(index->first));
+                    while (index != due.end()) {
+                        Core::ProxyType<Observation>& observation(_observations[*index]);
 
-                            if (plugin != nullptr) {
-                                Core::EnumerateType<PluginHost::IShell::reason> why(((value & MonitorObject::EXCEEDED_MEMORY) != 0) ? PluginHost::IShell::MEMORY_EXCEEDED : PluginHost::IShell::FAILURE);
+                        if (observation->Submit() == true) {
+                            PluginHost::WorkerPool::Instance().Submit(Core::ProxyType<Core::IDispatchType<void>>(observation));
+                        } else {
+                            // Still waiting for a worker thread, or still running, skip this one rather than piling up.
+                            _overruns++;
+                            TRACE_L1("Evaluation of %s is overdue, skipped.", observation->Callsign().c_str());
+                        }
 
-                                const string message("{\"callsign\": \"" + plugin->Callsign() + "\", \"action\": \"Deactivate\", \"reason\": \"" + why.Data() + "\" }");
-                                SYSLOG(Trace::Fatal, (_T("FORCED Shutdown: %s by reason: %s."), plugin->Callsign().c_str(), why.Data()));
+                        observation->Object().Retrigger(scheduledTime);
+                        _wheel.Insert(observation->Object().TimeSlot(), *index);
+                        index++;
+                    }
+                }
 
-                                _service->Notify(message);
+                uint64_t nextSlot(_wheel.Next());
 
-                                _parent.event_action(plugin->Callsign(), "Deactivate", why.Data());
+                if (nextSlot != static_cast<uint64_t>(~0)) {
+                    if (nextSlot < Core::Time::Now().Ticks()) {
+                        PluginHost::WorkerPool::Instance().Submit(_job);
+                    } else {
+                        nextSlot += 1000 /* Add 1 ms */;
+                        PluginHost::WorkerPool::Instance().Schedule(nextSlot, _job);
+                    }
+                }
+            }
+            void Evaluate(Observation& observation)
+            {
+                observation.Lock();
+                Act(observation.Callsign(), observation.Object().Evaluate(_adminLock));
+                const uint32_t pid(observation.Object().NewProcess());
+                observation.Unlock();
+
+                _probeLock.Lock();
+                if (_pressure != nullptr) {
+                    Watch(pid);
+                }
+                _probeLock.Unlock();
 
-                                PluginHost::WorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(plugin, PluginHost::IShell::DEACTIVATED, why.Value()));
+                _measured++;
+            }
+            // Memory pressure was reported, measure all observables right away, regardless of their interval.
+            void Pressured()
+            {
+                _probeLock.Lock();
+
+                _pressured = false;
+
+                if (_pressure != nullptr) {
+                    std::vector<Core::ProxyType<Observation>>::iterator index(_observations.begin());
+
+                    while (index != _observations.end()) {
+                        // An observable that is being evaluated is measured by that evaluation, never wait for
+                        // it here: its probe may hang, and the probe lock is held.
+                        if ((*index)->Submit() == true) {
+                            (*index)->Lock();
+                            Act((*index)->Callsign(), (*index)->Object().Measure(_adminLock));
+                            const uint32_t pid((*index)->Object().NewProcess());
+                            (*index)->Unlock();
+                            (*index)->Done();
+                            Watch(pid);
+                        }
+                        index++;
+                    }
 
-                                plugin->Release();
-                            }
+                    _measured++;
+
+                    _pressure->Cleanup();
+                }
+
+                _probeLock.Unlock();
+            }
+            inline void Watch(const uint32_t pid)
+            {
+                if (pid != 0) {
+                    _pressure->Watch(pid);
+                }
+            }
+            // The observation of the given callsign, if it is observed. The admin lock must be held.
+            Core::ProxyType<Observation> Observing(const string& callsign) const
+            {
+                Core::ProxyType<Observation> result;
+                std::vector<Core::ProxyType<Observation>>::const_iterator index(_observations.begin());
+
+                while ((index != _observations.end()) && ((*index)->Callsign() != callsign)) {
+                    index++;
+                }
+                if (index != _observations.end()) {
+                    result = *index;
+                }
+
+                return (result);
+            }
+            void Act(const string& callsign, const uint32_t value)
+            {
+                if ((value & (MonitorObject::NOT_OPERATIONAL | MonitorObject::EXCEEDED_MEMORY | MonitorObject::EXCEEDED_CPU | MonitorObject::LEAK_SUSPECTED)) != 0) {
+                    PluginHost::IShell* plugin(_service->QueryInterfaceByCallsign<PluginHost::IShell>(callsign));
+
+                    if (plugin != nullptr) {
+                        // There is no dedicated reason for a process spinning the CPU, it is restarted as a FAILURE.
+                        // A suspected leak is a planned restart ahead of the memory threshold, it counts as MEMORY_EXCEEDED.
+                        Core::EnumerateType<PluginHost::IShell::reason> why(((value & (MonitorObject::EXCEEDED_MEMORY | MonitorObject::LEAK_SUSPECTED)) != 0) ? PluginHost::IShell::MEMORY_EXCEEDED : PluginHost::IShell::FAILURE);
+                        const string reason((value & (MonitorObject::NOT_OPERATIONAL | MonitorObject::EXCEEDED_MEMORY | MonitorObject::EXCEEDED_CPU)) == 0 ? _T("LEAK_SUSPECTED") : why.Data());
+
+                        const string message("{\"callsign\": \"" + plugin->Callsign() + "\", \"action\": \"Deactivate\", \"reason\": \"" + reason + "\" }");
+                        SYSLOG(Trace::Fatal, (_T("FORCED Shutdown: %s by reason: %s."), plugin->Callsign().c_str(), reason.c_str()));
+
+                        _service->Notify(message);
+
+                        _parent.event_action(plugin->Callsign(), "Deactivate", reason);
+
+                        PluginHost::WorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(plugin, PluginHost::IShell::DEACTIVATED, why.Value()));
+
+                        plugin->Release();
+                    }
+                }
+            }
+
+            void Render(string& text)
+            {
+                OpenMetrics metrics(text);
+                std::map<string, MonitorObject>::iterator index;
+
+                metrics.Family(_T("monitor_operational"), OpenMetrics::GAUGE, _T("1 if the observable is up and reports to be operational."));
+                for (index = _monitor.begin(); index != _monitor.end(); index++) {
+                    metrics.Sample(OpenMetrics::Label(_T("callsign"), index->first), index->second.Measurement().Operational() ? 1 : 0);
+                }
+
+                Gauge(metrics, _T("monitor_resident_bytes"), _T("Resident memory of all processes of the observable."), [](const MetaData& data) { return (data.Resident().Last()); });
+                Gauge(metrics, _T("monitor_allocated_bytes"), _T("Allocated memory of all processes of the observable."), [](const MetaData& data) { return (data.Allocated().Last()); });
+                Gauge(metrics, _T("monitor_shared_bytes"), _T("Shared memory of all processes of the observable."), [](const MetaData& data) { return (data.Shared().Last()); });
+                Gauge(metrics, _T("monitor_processes"), _T("Number of processes of the observable."), [](const MetaData& data) { return (static_cast<uint64_t>(data.Process().Last())); });
+                Gauge(metrics, _T("monitor_cpu_percent"), _T("CPU load of the processes of the observable, in percent of a single core."), [](const MetaData& data) { return (data.CPU().Last()); });
+                Gauge(metrics, _T("monitor_measurements"), _T("Number of measurements since the last reset."), [](const MetaData& data) { return (static_cast<uint64_t>(data.Allocated().Measurements())); });
+
+                PerProcess(metrics, _T("monitor_process_pss_bytes"), _T("Proportional set size of a process of the observable."), [](const MetaData::Footprint& footprint) { return (footprint.Pss().Last()); });
+                PerProcess(metrics, _T("monitor_process_private_clean_bytes"), _T("Private clean memory of a process of the observable."), [](const MetaData::Footprint& footprint) { return (footprint.PrivateClean().Last()); });
+                PerProcess(metrics, _T("monitor_process_private_dirty_bytes"), _T("Private dirty memory of a process of the observable."), [](const MetaData::Footprint& footprint) { return (footprint.PrivateDirty().Last()); });
+                PerProcess(metrics, _T("monitor_process_swap_bytes"), _T("Swapped out memory of a process of the observable."), [](const MetaData::Footprint& footprint) { return (footprint.Swap().Last()); });
+
+                metrics.Family(_T("monitor_probe_latency_microseconds"), OpenMetrics::HISTOGRAM, _T("Round-trip time of the operational probes."));
+                for (index = _monitor.begin(); index != _monitor.end(); index++) {
+                    const LatencyHistogram& latency(index->second.Measurement().Latency());
+
+                    if (latency.Count() > 0) {
+                        const string callsign(OpenMetrics::Label(_T("callsign"), index->first));
+                        uint64_t cumulative = 0;
+
+                        for (uint8_t bucket = 0; bucket < LatencyHistogram::Buckets; bucket++) {
+                            bool last = ((bucket + 1) == LatencyHistogram::Buckets);
+
+                            cumulative += latency.Count(bucket);
+                            metrics.Sample(_T("_bucket"), callsign + _T(",") + OpenMetrics::Label(_T("le"), (last == true ? string(_T("+Inf")) : Core::NumberType<uint64_t>(LatencyHistogram::Bound(bucket)).Text())), cumulative);
                         }
-                        info.Retrigger(scheduledTime);
+
+                        metrics.Sample(_T("_count"), callsign, latency.Count());
+                        metrics.Sample(_T("_sum"), callsign, latency.Sum());
                     }
+                }
+
+                metrics.Family(_T("monitor_scheduler_tick_observables"), OpenMetrics::GAUGE, _T("Observables submitted for evaluation per turn of the scheduling wheel."));
+                if (_tickLoad.Measurements() > 0) {
+                    metrics.Sample(_T("stat=\"min\""), _tickLoad.Min());
+                    metrics.Sample(_T("stat=\"max\""), _tickLoad.Max());
+                    metrics.Sample(_T("stat=\"average\""), _tickLoad.Average());
+                    metrics.Sample(_T("stat=\"last\""), _tickLoad.Last());
+                }
 
-                    if (info.TimeSlot() < nextSlot) {
-                        nextSlot = info.TimeSlot();
+                metrics.Family(_T("monitor_scheduler_overruns"), OpenMetrics::COUNTER, _T("Evaluations skipped as the previous one was still waiting for a worker or running."));
+                metrics.Sample(string(), _overruns.load());
+
+                metrics.Family(_T("monitor_restarts"), OpenMetrics::COUNTER, _T("Restarts of the observable by the monitor."));
+                for (index = _monitor.begin(); index != _monitor.end(); index++) {
+                    const string callsign(OpenMetrics::Label(_T("callsign"), index->first));
+
+                    metrics.Sample(callsign + _T(",reason=\"memory\""), index->second.Restarts(PluginHost::IShell::MEMORY_EXCEEDED));
+                    metrics.Sample(callsign + _T(",reason=\"operational\""), index->second.Restarts(PluginHost::IShell::FAILURE));
+                }
+
+                metrics.Family(_T("monitor_restart_limit"), OpenMetrics::GAUGE, _T("Restarts allowed within the restart window, 0 is unlimited."));
+                for (index = _monitor.begin(); index != _monitor.end(); index++) {
+                    if (index->second.HasRestartAllowed() == true) {
+                        const string callsign(OpenMetrics::Label(_T("callsign"), index->first));
+
+                        metrics.Sample(callsign + _T(",reason=\"memory\""), index->second.RestartLimit(PluginHost::IShell::MEMORY_EXCEEDED));
+                        metrics.Sample(callsign + _T(",reason=\"operational\""), index->second.RestartLimit(PluginHost::IShell::FAILURE));
+                    }
+                }
+
+                metrics.Family(_T("monitor_restart_window_seconds"), OpenMetrics::GAUGE, _T("Window in which the restart limit applies."));
+                for (index = _monitor.begin(); index != _monitor.end(); index++) {
+                    if (index->second.HasRestartAllowed() == true) {
+                        const string callsign(OpenMetrics::Label(_T("callsign"), index->first));
+
+                        metrics.Sample(callsign + _T(",reason=\"memory\""), index->second.RestartWindow(PluginHost::IShell::MEMORY_EXCEEDED));
+                        metrics.Sample(callsign + _T(",reason=\"operational\""), index->second.RestartWindow(PluginHost::IShell::FAILURE));
                     }
+                }
+            }
+            template <typename VALUE>
+            void Gauge(OpenMetrics& metrics, const TCHAR name[], const TCHAR help[], VALUE value) const
+            {
+                metrics.Family(name, OpenMetrics::GAUGE, help);
+
+                std::map<string, MonitorObject>::const_iterator index(_monitor.begin());
 
+                while (index != _monitor.end()) {
+                    if (index->second.HasMeasurement() == true) {
+                        metrics.Sample(OpenMetrics::Label(_T("callsign"), index->first), value(index->second.Measurement()));
+                    }
                     index++;
                 }
+            }
+            template <typename VALUE>
+            void PerProcess(OpenMetrics& metrics, const TCHAR name[], const TCHAR help[], VALUE value) const
+            {
+                metrics.Family(name, OpenMetrics::GAUGE, help);
 
-                if (nextSlot != static_cast<uint64_t>(~0)) {
-                    if (nextSlot < Core::Time::Now().Ticks()) {
-                        PluginHost::WorkerPool::Instance().Submit(_job);
-                    } else {
-                        nextSlot += 1000 /* Add 1 ms */;
-                        PluginHost::WorkerPool::Instance().Schedule(nextSlot, _job);
+                std::map<string, MonitorObject>::const_iterator index(_monitor.begin());
+
+                while (index != _monitor.end()) {
+                    const std::list<MetaData::Footprint>& processes(index->second.Measurement().Processes());
+                    std::list<MetaData::Footprint>::const_iterator process(processes.begin());
+
+                    while (process != processes.end()) {
+                        metrics.Sample(OpenMetrics::Label(_T("callsign"), index->first) + _T(",") + OpenMetrics::Label(_T("pid"), Core::NumberType<uint32_t>(process->Id()).Text()), value(*process));
+                        process++;
                     }
+                    index++;
                 }
             }
 
@@ -1046,8 +2215,19 @@ namespace Plugin {
             }
 
             Core::CriticalSection _adminLock;
+            Core::CriticalSection _probeLock;
             std::map<string, MonitorObject> _monitor;
+            std::vector<Core::ProxyType<Observation>> _observations;
+            TimerWheel<uint32_t> _wheel; // Holds the index in _observations, only touched by the Probe.
+            Core::MeasurementType<uint32_t> _tickLoad; // Observables submitted per turn of the wheel.
+            std::atomic<uint32_t> _overruns;
             Core::ProxyType<Core::IDispatchType<void>> _job;
+            Core::ProxyType<Core::IDispatchType<void>> _pressureJob;
+            MemoryPressure* _pressure;
+            std::atomic<bool> _pressured;
+            std::atomic<uint32_t> _measured; // Bumped on every change that shows in the metrics.
+            uint32_t _rendered;
+            string _metrics;
             PluginHost::IShell* _service;
             Monitor& _parent;
         };
@@ -1120,6 +2300,7 @@ namespace Plugin {
         uint32_t endpoint_restartlimits(const JsonData::Monitor::RestartlimitsParamsData& params);
         uint32_t endpoint_resetstats(const JsonData::Monitor::ResetstatsParamsData& params, JsonData::Monitor::InfoInfo& response);
         uint32_t get_status(const string& index, Core::JSON::ArrayType<JsonData::Monitor::InfoInfo>& response) const;
+        uint32_t endpoint_history(const Data::Range& params, Data::History& response);
         void event_action(const string& callsign, const string& action, const string& reason);
     };
 }
@@ -16,6 +16,7 @@ namespace Plugin {
         Register<RestartlimitsParamsData,void>(_T("restartlimits"), &Monitor::endpoint_restartlimits, this);
         Register<ResetstatsParamsData,InfoInfo>(_T("resetstats"), &Monitor::endpoint_resetstats, this);
         Property<Core::JSON::ArrayType<InfoInfo>>(_T("status"), &Monitor::get_status, nullptr, this);
+        Register<Data::Range,Data::History>(_T("history"), &Monitor::endpoint_history, this);
     }
 
     void Monitor::UnregisterAll()
@@ -23,6 +24,7 @@ namespace Plugin {
         Unregister(_T("resetstats"));
         Unregister(_T("restartlimits"));
         Unregister(_T("status"));
+        Unregister(_T("history"));
     }
 
     // API implementation
@@ -57,6 +59,21 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+    // Method: history - The recorded measurements of a single plugin watched by the Monitor, within a time range
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNKNOWN_KEY: The plugin is not watched by the Monitor
+    uint32_t Monitor::endpoint_history(const Data::Range& params, Data::History& response)
+    {
+        uint32_t result = Core::ERROR_UNKNOWN_KEY;
+
+        if (_monitor->History(params.Callsign.Value(), params.From.Value(), params.To.Value(), params.Resolution.Value(), response) == true) {
+            result = Core::ERROR_NONE;
+        }
+
+        return (result);
+    }
+
     // Property: status - The memory and process statistics either for a single plugin or all plugins watched by the Monitor
     // Return codes:
     //  - ERROR_NONE: Success
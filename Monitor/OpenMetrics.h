@@ -0,0 +1,105 @@
+#ifndef __MONITOR_OPENMETRICS_H
+#define __MONITOR_OPENMETRICS_H
+
+#include "Module.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Renders metrics in the Prometheus text format, version 0.0.4, which OpenMetrics scrapers take too. The
+    // framework can only send it as text/plain, and that is what this version is served as. All samples of a
+    // metric must follow its HELP and TYPE lines, so announce the Family first and then add its Samples. The
+    // text is built in the given string, which keeps its capacity between renders.
+    class OpenMetrics {
+    public:
+        enum type : uint8_t {
+            GAUGE,
+            COUNTER,
+            HISTOGRAM
+        };
+
+    public:
+        OpenMetrics() = delete;
+        OpenMetrics(const OpenMetrics&) = delete;
+        OpenMetrics& operator=(const OpenMetrics&) = delete;
+
+        OpenMetrics(string& text)
+            : _text(text)
+            , _name()
+        {
+            _text.clear();
+        }
+        ~OpenMetrics()
+        {
+        }
+
+    public:
+        void Family(const TCHAR name[], const type kind, const TCHAR help[])
+        {
+            _name = name;
+
+            if (kind == COUNTER) {
+                // Counters are named with the suffix, in the TYPE line as well as in the samples.
+                _name += _T("_total");
+            }
+
+            _text += _T("# HELP ");
+            _text += _name;
+            _text += ' ';
+            _text += help;
+            _text += '\n';
+            _text += _T("# TYPE ");
+            _text += _name;
+            _text += (kind == COUNTER ? _T(" counter\n") : (kind == HISTOGRAM ? _T(" histogram\n") : _T(" gauge\n")));
+        }
+        // The labels are a comma separated list of Label()s, if any.
+        void Sample(const string& labels, const uint64_t value)
+        {
+            Sample(_T(""), labels, value);
+        }
+        // The samples of a histogram are told apart by their suffix: "_bucket", "_count" and "_sum".
+        void Sample(const TCHAR suffix[], const string& labels, const uint64_t value)
+        {
+            _text += _name;
+            _text += suffix;
+
+            if (labels.empty() == false) {
+                _text += '{';
+                _text += labels;
+                _text += '}';
+            }
+
+            _text += ' ';
+            _text += Core::NumberType<uint64_t>(value).Text();
+            _text += '\n';
+        }
+        static string Label(const TCHAR key[], const string& value)
+        {
+            string result(key);
+
+            result += _T("=\"");
+
+            for (string::const_iterator index(value.begin()); index != value.end(); index++) {
+                if (*index == '\n') {
+                    result += _T("\\n");
+                } else {
+                    if ((*index == '\\') || (*index == '"')) {
+                        result += '\\';
+                    }
+                    result += *index;
+                }
+            }
+
+            result += '"';
+
+            return (result);
+        }
+
+    private:
+        string& _text;
+        string _name;
+    };
+}
+}
+
+#endif // __MONITOR_OPENMETRICS_H
@@ -0,0 +1,89 @@
+#ifndef __MONITOR_PROCESSMEMORY_H
+#define __MONITOR_PROCESSMEMORY_H
+
+#include "Module.h"
+
+#ifndef __WIN32__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Reads the memory breakdown of a single process from /proc/<pid>/smaps_rollup (Linux 4.14 and up). Unlike
+    // the resident size, the proportional set size (Pss) divides the shared pages over the processes sharing
+    // them, so the Pss of the processes of different plugins can be added up and compared. The private pages
+    // (Uss) are the pages that would be freed if the process would go away.
+    class ProcessMemory {
+    public:
+        struct Rollup {
+            uint64_t Pss;
+            uint64_t PrivateClean;
+            uint64_t PrivateDirty;
+            uint64_t Swap;
+        };
+
+    private:
+        ProcessMemory() = delete;
+        ProcessMemory(const ProcessMemory&) = delete;
+        ProcessMemory& operator=(const ProcessMemory&) = delete;
+
+    public:
+        // All values are in bytes. Returns false if the process is gone or the kernel does not offer a rollup.
+        static bool Read(const uint32_t pid, Rollup& rollup)
+        {
+            bool result = false;
+#ifndef __WIN32__
+            char buffer[2048];
+            string fileName(_T("/proc/") + Core::NumberType<uint32_t>(pid).Text() + _T("/smaps_rollup"));
+            int fd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+
+            if (fd != -1) {
+                ssize_t length = ::read(fd, buffer, sizeof(buffer) - 1);
+
+                if (length > 0) {
+                    const char* line = buffer;
+
+                    buffer[length] = '\0';
+                    rollup.Pss = 0;
+                    rollup.PrivateClean = 0;
+                    rollup.PrivateDirty = 0;
+                    rollup.Swap = 0;
+
+                    // The first line holds the address range, the others are "<Key>: <value> kB".
+                    while (line != nullptr) {
+                        char key[32];
+                        unsigned long long value;
+
+                        if (::sscanf(line, "%31[^:]: %llu kB", key, &value) == 2) {
+                            if (::strcmp(key, "Pss") == 0) {
+                                rollup.Pss = value * 1024;
+                                result = true;
+                            } else if (::strcmp(key, "Private_Clean") == 0) {
+                                rollup.PrivateClean = value * 1024;
+                            } else if (::strcmp(key, "Private_Dirty") == 0) {
+                                rollup.PrivateDirty = value * 1024;
+                            } else if (::strcmp(key, "Swap") == 0) {
+                                rollup.Swap = value * 1024;
+                            }
+                        }
+
+                        line = ::strchr(line, '\n');
+
+                        if (line != nullptr) {
+                            line++;
+                        }
+                    }
+                }
+
+                ::close(fd);
+            }
+#endif
+            return (result);
+        }
+    };
+}
+}
+
+#endif // __MONITOR_PROCESSMEMORY_H
@@ -0,0 +1,218 @@
+#ifndef __MONITOR_PROCESSUSAGE_H
+#define __MONITOR_PROCESSUSAGE_H
+
+#include "Module.h"
+
+#ifndef __WIN32__
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Accounts the CPU time (utime + stime from /proc/<pid>/stat) spent by the out-of-process host of a
+    // plugin and its child processes. The host is the process started with "-C <callsign>", it is looked
+    // up once and only looked up again if it is gone. Plugins running in-process can not be told apart
+    // from the framework itself, for those nothing is measured. Not finding the host is remembered as
+    // well, until the next Reset(), so these do not scan all of /proc on every measurement.
+    class ProcessUsage {
+    public:
+        ProcessUsage() = delete;
+        ProcessUsage& operator=(const ProcessUsage&) = delete;
+
+        ProcessUsage(const string& callsign)
+            : _callsign(callsign)
+            , _main(0)
+            , _searched(false)
+            , _ticks(0)
+            , _timestamp(0)
+            , _processes()
+        {
+        }
+        ProcessUsage(const ProcessUsage& copy)
+            : _callsign(copy._callsign)
+            , _main(copy._main)
+            , _searched(copy._searched)
+            , _ticks(copy._ticks)
+            , _timestamp(copy._timestamp)
+            , _processes(copy._processes)
+        {
+        }
+        ~ProcessUsage()
+        {
+        }
+
+    public:
+        // The host process, 0 if it has not been found (yet).
+        inline uint32_t Id() const
+        {
+            return (_main);
+        }
+        // The host process followed by its children, as found by the last measurement.
+        inline void Processes(std::list<uint32_t>& pids) const
+        {
+            pids.insert(pids.end(), _processes.begin(), _processes.end());
+        }
+        // Forget the process and the previous sample, e.g. because the plugin got (re)activated.
+        inline void Reset()
+        {
+            _main = 0;
+            _searched = false;
+            _timestamp = 0;
+            _processes.clear();
+        }
+
+        // Load in percent of a single core, averaged since the previous call. Returns false if there is
+        // nothing to report: no process found or this is the first sample for the (new) process.
+        bool Measure(uint64_t& load)
+        {
+            bool result = false;
+            uint64_t ticks = 0;
+
+            if ((_main != 0) && (Ticks(_main, ticks) == false)) {
+                // The process is gone, probably restarted, start all over.
+                Reset();
+            }
+
+            if ((_main == 0) && (_searched == false)) {
+                _searched = true;
+
+                if (Locate() == true) {
+                    Ticks(_main, ticks);
+                }
+            }
+
+            if (_main != 0) {
+                uint64_t now = Core::Time::Now().Ticks();
+                Core::ProcessInfo::Iterator children(_main);
+
+                // The children are walked once, the same list serves the breakdown per process.
+                _processes.clear();
+                _processes.push_back(_main);
+
+                while (children.Next() == true) {
+                    uint64_t childTicks = 0;
+
+                    _processes.push_back(children.Current().Id());
+
+                    if (Ticks(children.Current().Id(), childTicks) == true) {
+                        ticks += childTicks;
+                    }
+                }
+
+                if ((_timestamp != 0) && (now > _timestamp)) {
+                    // Children that exited take their ticks with them, do not report that as negative load.
+                    uint64_t spent = (ticks > _ticks ? ticks - _ticks : 0);
+
+                    load = (spent * 100 * 1000 * 1000) / (ClockTicks() * (now - _timestamp));
+                    result = true;
+                }
+
+                _ticks = ticks;
+                _timestamp = now;
+            }
+
+            return (result);
+        }
+
+    private:
+        static uint64_t ClockTicks()
+        {
+#ifndef __WIN32__
+            static const uint64_t ticks = static_cast<uint64_t>(::sysconf(_SC_CLK_TCK));
+            return (ticks > 0 ? ticks : 100);
+#else
+            return (100);
+#endif
+        }
+        static uint32_t Read(const string& fileName, char buffer[], const uint32_t length)
+        {
+            uint32_t result = 0;
+#ifndef __WIN32__
+            int fd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+
+            if (fd != -1) {
+                ssize_t size = ::read(fd, buffer, length - 1);
+
+                if (size > 0) {
+                    result = static_cast<uint32_t>(size);
+                }
+
+                ::close(fd);
+            }
+#endif
+            buffer[result] = '\0';
+
+            return (result);
+        }
+        static bool Ticks(const uint32_t pid, uint64_t& ticks)
+        {
+            char buffer[512];
+            bool result = false;
+
+            if (Read(_T("/proc/") + Core::NumberType<uint32_t>(pid).Text() + _T("/stat"), buffer, sizeof(buffer)) > 0) {
+                // The command name can hold spaces and braces, the fields we want follow the last ')'.
+                const char* position = ::strrchr(buffer, ')');
+
+                if (position != nullptr) {
+                    unsigned long long utime = 0;
+                    unsigned long long stime = 0;
+
+                    // Fields 3 up to 13 are skipped, utime and stime are field 14 and 15.
+                    if (::sscanf(position + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &utime, &stime) == 2) {
+                        ticks = utime + stime;
+                        result = true;
+                    }
+                }
+            }
+
+            return (result);
+        }
+        bool Locate()
+        {
+#ifndef __WIN32__
+            DIR* dir = ::opendir("/proc");
+
+            if (dir != nullptr) {
+                struct dirent* entry;
+
+                while ((_main == 0) && ((entry = ::readdir(dir)) != nullptr)) {
+                    if ((entry->d_name[0] >= '1') && (entry->d_name[0] <= '9')) {
+                        char buffer[1024];
+                        uint32_t length = Read(_T("/proc/") + string(entry->d_name) + _T("/cmdline"), buffer, sizeof(buffer));
+                        const char* current = buffer;
+                        const char* end = &(buffer[length]);
+
+                        // Arguments are separated by a '\0', look for "-C <callsign>".
+                        while ((_main == 0) && (current < end)) {
+                            const char* next = current + ::strlen(current) + 1;
+
+                            if ((next < end) && ((::strcmp(current, "-C") == 0) || (::strcmp(current, "--callsign") == 0)) && (_callsign == next)) {
+                                _main = static_cast<uint32_t>(::atoi(entry->d_name));
+                            }
+
+                            current = next;
+                        }
+                    }
+                }
+
+                ::closedir(dir);
+            }
+#endif
+            return (_main != 0);
+        }
+
+    private:
+        string _callsign;
+        uint32_t _main;
+        bool _searched;
+        uint64_t _ticks;
+        uint64_t _timestamp;
+        std::list<uint32_t> _processes;
+    };
+}
+}
+
+#endif // __MONITOR_PROCESSUSAGE_H
@@ -0,0 +1,159 @@
+#ifndef __MONITOR_TIMERWHEEL_H
+#define __MONITOR_TIMERWHEEL_H
+
+#include "Module.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // A hierarchical timer wheel: time is cut in ticks and every level has 2^BITS slots, each slot of a level
+    // spanning all slots of the level below. An element is put in the lowest level that reaches its expiry,
+    // and moves down a level (cascades) once the wheel gets close. Inserting and expiring costs the same,
+    // whatever the number of elements, and only the slots that are due are ever looked at. Elements further
+    // away than the highest level reaches, are parked in its last slot and re-inserted once they cascade.
+    template <typename ELEMENT, const uint8_t LEVELS = 3, const uint8_t BITS = 6>
+    class TimerWheel {
+    private:
+        static constexpr uint32_t Slots = (1 << BITS);
+        static constexpr uint32_t Mask = (Slots - 1);
+
+        struct Entry {
+            uint64_t Expiry; // In ticks.
+            ELEMENT Element;
+        };
+
+    public:
+        TimerWheel() = delete;
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        // The tick is the resolution of the wheel, all times are in the same unit (e.g. microseconds).
+        TimerWheel(const uint64_t tick)
+            : _tick(tick)
+            , _current(0)
+            , _count(0)
+        {
+            ASSERT(tick != 0);
+        }
+        ~TimerWheel()
+        {
+        }
+
+    public:
+        inline uint32_t Count() const
+        {
+            return (_count);
+        }
+        void Clear()
+        {
+            for (uint8_t level = 0; level < LEVELS; level++) {
+                for (uint32_t slot = 0; slot < Slots; slot++) {
+                    _slots[level][slot].clear();
+                }
+            }
+
+            _count = 0;
+        }
+        // Elements are never reported early, an expiry in the past is reported with the next tick. Advance the
+        // wheel to the current time before the first element is inserted.
+        void Insert(const uint64_t time, const ELEMENT& element)
+        {
+            Entry entry;
+
+            entry.Expiry = std::max((time + _tick - 1) / _tick, _current + 1);
+            entry.Element = element;
+
+            Place(entry);
+
+            _count++;
+        }
+        // Turn the wheel up to "now", and add all elements that expired on the way to "due".
+        void Advance(const uint64_t now, std::vector<ELEMENT>& due)
+        {
+            const uint64_t target = now / _tick;
+
+            if (_count == 0) {
+                _current = std::max(_current, target);
+            }
+
+            while ((_current < target) && (_count > 0)) {
+                _current++;
+
+                // Cascade from the top down, so elements can go down more than one level at once.
+                for (uint8_t level = LEVELS - 1; level > 0; level--) {
+                    if ((_current & ((1ULL << (level * BITS)) - 1)) == 0) {
+                        Cascade(level);
+                    }
+                }
+
+                std::list<Entry>& slot(_slots[0][_current & Mask]);
+
+                while (slot.empty() == false) {
+                    due.push_back(slot.front().Element);
+                    slot.pop_front();
+                    _count--;
+                }
+            }
+
+            _current = std::max(_current, target);
+        }
+        // The first time the wheel has to be turned, either to report or to cascade elements. ~0 if it is empty.
+        uint64_t Next() const
+        {
+            uint64_t result = static_cast<uint64_t>(~0);
+
+            if (_count > 0) {
+                uint64_t tick = _current + 1;
+
+                while ((tick <= (_current + Slots)) && (_slots[0][tick & Mask].empty() == true) && ((tick & Mask) != 0)) {
+                    tick++;
+                }
+
+                result = tick * _tick;
+            }
+
+            return (result);
+        }
+
+    private:
+        void Place(const Entry& entry)
+        {
+            const uint64_t delta = (entry.Expiry > _current ? entry.Expiry - _current : 0);
+            uint64_t position = entry.Expiry;
+            uint8_t level = 0;
+
+            while (((level + 1) < LEVELS) && (delta >= (1ULL << ((level + 1) * BITS)))) {
+                level++;
+            }
+
+            if (delta >= (1ULL << (LEVELS * BITS))) {
+                // Beyond the reach of the wheel, park it as far away as possible.
+                position = _current + (1ULL << (LEVELS * BITS)) - 1;
+            }
+
+            _slots[level][(position >> (level * BITS)) & Mask].push_back(entry);
+        }
+        void Cascade(const uint8_t level)
+        {
+            std::list<Entry> entries;
+
+            entries.swap(_slots[level][(_current >> (level * BITS)) & Mask]);
+
+            typename std::list<Entry>::const_iterator index(entries.begin());
+
+            while (index != entries.end()) {
+                Place(*index);
+                index++;
+            }
+        }
+
+    private:
+        const uint64_t _tick;
+        uint64_t _current;
+        uint32_t _count;
+        std::list<Entry> _slots[LEVELS][Slots];
+    };
+}
+}
+
+#endif // __MONITOR_TIMERWHEEL_H
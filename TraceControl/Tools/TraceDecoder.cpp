@@ -0,0 +1,195 @@
+// Decodes the binary trace recordings written by the TraceControl plugin (see TraceRecorder.h) into
+// text or JSON lines. The files of a ring can be passed in any order, they are decoded oldest first.
+//
+// Usage: TraceDecoder [--json] <trace.N.bin> [<trace.N.bin> ...]
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+static constexpr uint32_t Magic = 0x42435254;
+static constexpr uint16_t Version = 1;
+static constexpr uint16_t HeaderSize = 4 + 2 + 2 + 4 + 4;
+static constexpr uint16_t EntrySize = 1 + 8 + 4 + (4 * 2) + 2;
+static constexpr uint16_t StringSize = 1 + 2 + 2;
+
+enum record : uint8_t {
+    STRING = 1,
+    ENTRY = 2
+};
+
+struct Recording {
+    std::string Name;
+    uint32_t Sequence;
+    std::vector<uint8_t> Data;
+};
+
+template <typename TYPE>
+static TYPE Load(const uint8_t* buffer)
+{
+    TYPE result = 0;
+
+    for (uint8_t index = 0; index < sizeof(TYPE); index++) {
+        result |= (static_cast<TYPE>(buffer[index]) << (8 * index));
+    }
+
+    return (result);
+}
+
+static std::string Escape(const char* text, const uint32_t length)
+{
+    std::string result;
+
+    for (uint32_t index = 0; index < length; index++) {
+        char character = text[index];
+
+        if ((character == '"') || (character == '\\')) {
+            result += '\\';
+            result += character;
+        } else if (static_cast<uint8_t>(character) < 0x20) {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", static_cast<uint8_t>(character));
+            result += code;
+        } else {
+            result += character;
+        }
+    }
+
+    return (result);
+}
+
+static bool Read(const char fileName[], Recording& recording)
+{
+    bool result = false;
+    FILE* file = fopen(fileName, "rb");
+
+    if (file != nullptr) {
+        uint8_t buffer[64 * 1024];
+        size_t length;
+
+        while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            recording.Data.insert(recording.Data.end(), buffer, buffer + length);
+        }
+
+        fclose(file);
+
+        if ((recording.Data.size() >= HeaderSize) && (Load<uint32_t>(&(recording.Data[0])) == Magic) && (Load<uint16_t>(&(recording.Data[4])) == Version)) {
+            uint32_t used = Load<uint32_t>(&(recording.Data[12]));
+
+            // A recording that was not closed properly still has its full size, only "used" is valid.
+            if ((used >= HeaderSize) && (used <= recording.Data.size())) {
+                recording.Data.resize(used);
+                recording.Name = fileName;
+                recording.Sequence = Load<uint32_t>(&(recording.Data[8]));
+                result = true;
+            }
+        }
+    }
+
+    return (result);
+}
+
+static void Decode(const Recording& recording, const bool json)
+{
+    std::vector<std::string> strings;
+    const uint8_t* data = recording.Data.data();
+    uint32_t offset = HeaderSize;
+    const uint32_t end = static_cast<uint32_t>(recording.Data.size());
+
+    while (offset < end) {
+        if ((data[offset] == STRING) && ((offset + StringSize) <= end)) {
+            uint16_t id = Load<uint16_t>(&(data[offset + 1]));
+            uint16_t length = Load<uint16_t>(&(data[offset + 3]));
+
+            if ((offset + StringSize + length) > end) {
+                break;
+            }
+            if (id >= strings.size()) {
+                strings.resize(id + 1);
+            }
+
+            strings[id].assign(reinterpret_cast<const char*>(&(data[offset + StringSize])), length);
+            offset += StringSize + length;
+        } else if ((data[offset] == ENTRY) && ((offset + EntrySize) <= end)) {
+            uint64_t timestamp = Load<uint64_t>(&(data[offset + 1]));
+            uint32_t lineNumber = Load<uint32_t>(&(data[offset + 9]));
+            uint16_t ids[4];
+            uint16_t length = Load<uint16_t>(&(data[offset + 21]));
+            static const std::string unknown("?");
+
+            for (uint8_t index = 0; index < 4; index++) {
+                ids[index] = Load<uint16_t>(&(data[offset + 13 + (2 * index)]));
+            }
+            if ((offset + EntrySize + length) > end) {
+                break;
+            }
+
+            const std::string& file(ids[0] < strings.size() ? strings[ids[0]] : unknown);
+            const std::string& module(ids[1] < strings.size() ? strings[ids[1]] : unknown);
+            const std::string& category(ids[2] < strings.size() ? strings[ids[2]] : unknown);
+            const std::string& className(ids[3] < strings.size() ? strings[ids[3]] : unknown);
+            const char* information = reinterpret_cast<const char*>(&(data[offset + EntrySize]));
+
+            if (json == true) {
+                printf("{\"timestamp\":%llu,\"file\":\"%s\",\"line\":%u,\"module\":\"%s\",\"category\":\"%s\",\"class\":\"%s\",\"message\":\"%s\"}\n",
+                    static_cast<unsigned long long>(timestamp), Escape(file.c_str(), file.length()).c_str(), lineNumber,
+                    Escape(module.c_str(), module.length()).c_str(), Escape(category.c_str(), category.length()).c_str(),
+                    Escape(className.c_str(), className.length()).c_str(), Escape(information, length).c_str());
+            } else {
+                time_t seconds = static_cast<time_t>(timestamp / 1000000);
+                struct tm moment;
+                char stamp[32];
+
+                gmtime_r(&seconds, &moment);
+                strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &moment);
+
+                printf("[%s.%06u]:[%s:%u] %s/%s: %.*s\n", stamp, static_cast<uint32_t>(timestamp % 1000000), file.c_str(), lineNumber,
+                    module.c_str(), category.c_str(), static_cast<int>(length), information);
+            }
+
+            offset += EntrySize + length;
+        } else {
+            fprintf(stderr, "%s: corrupt record at offset %u\n", recording.Name.c_str(), offset);
+            break;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<Recording> recordings;
+    bool json = false;
+
+    for (int index = 1; index < argc; index++) {
+        if (strcmp(argv[index], "--json") == 0) {
+            json = true;
+        } else {
+            Recording recording;
+
+            if (Read(argv[index], recording) == true) {
+                recordings.push_back(recording);
+            } else {
+                fprintf(stderr, "%s: not a trace recording\n", argv[index]);
+            }
+        }
+    }
+
+    if (recordings.empty() == true) {
+        fprintf(stderr, "Usage: %s [--json] <trace.N.bin> [<trace.N.bin> ...]\n", argv[0]);
+        return (1);
+    }
+
+    std::sort(recordings.begin(), recordings.end(), [](const Recording& lhs, const Recording& rhs) {
+        return (lhs.Sequence < rhs.Sequence);
+    });
+
+    for (const Recording& recording : recordings) {
+        Decode(recording, json);
+    }
+
+    return (0);
+}
@@ -0,0 +1,161 @@
+// Receives the batched remote traces sent by the TraceControl plugin (see TraceRemote.h), prints
+// every entry and keeps track of the lost datagrams using the sequence numbers, and of the entries the
+// sender had to drop using the counter in the datagram header.
+//
+// Usage: TraceReceiver [port] (default 2200)
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+static constexpr uint16_t Magic = 0x5254;
+static constexpr uint16_t HeaderSize = 2 + 2 + 4 + 4;
+static constexpr uint16_t EntryHeaderSize = 2 + 8 + 4;
+
+static volatile sig_atomic_t g_running = 1;
+
+static void Stop(int)
+{
+    g_running = 0;
+}
+
+template <typename TYPE>
+static TYPE Load(const uint8_t* buffer)
+{
+    TYPE result = 0;
+
+    for (uint8_t index = 0; index < sizeof(TYPE); index++) {
+        result |= (static_cast<TYPE>(buffer[index]) << (8 * index));
+    }
+
+    return (result);
+}
+
+// Returns the pointer past the string, or nullptr if it is not terminated within the entry.
+static const char* Next(const char* current, const char* end)
+{
+    const char* marker = static_cast<const char*>(memchr(current, '\0', end - current));
+
+    return (marker != nullptr ? marker + 1 : nullptr);
+}
+
+static bool Print(const uint8_t* entry, const uint16_t length)
+{
+    const char* end = reinterpret_cast<const char*>(entry + length);
+    const char* file = reinterpret_cast<const char*>(entry + EntryHeaderSize);
+    const char* module = Next(file, end);
+    const char* category = (module != nullptr ? Next(module, end) : nullptr);
+    const char* className = (category != nullptr ? Next(category, end) : nullptr);
+    const char* information = (className != nullptr ? Next(className, end) : nullptr);
+
+    if (information != nullptr) {
+        uint64_t timestamp = Load<uint64_t>(entry + 2);
+        uint32_t lineNumber = Load<uint32_t>(entry + 10);
+        time_t seconds = static_cast<time_t>(timestamp / 1000000);
+        struct tm moment;
+        char stamp[32];
+
+        gmtime_r(&seconds, &moment);
+        strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &moment);
+
+        printf("[%s.%06u]:[%s:%u] %s/%s: %.*s\n", stamp, static_cast<uint32_t>(timestamp % 1000000), file, lineNumber,
+            module, category, static_cast<int>(end - information), information);
+    }
+
+    return (information != nullptr);
+}
+
+int main(int argc, char* argv[])
+{
+    uint16_t port = (argc > 1 ? static_cast<uint16_t>(atoi(argv[1])) : 2200);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in address;
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    if ((fd == -1) || (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)) {
+        fprintf(stderr, "Could not listen on port %u\n", port);
+        return (1);
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = Stop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    uint8_t datagram[65536];
+    uint32_t expected = 0;
+    uint64_t datagrams = 0;
+    uint64_t entries = 0;
+    uint64_t lost = 0;
+    uint32_t dropped = 0;
+    uint64_t malformed = 0;
+
+    while (g_running != 0) {
+        ssize_t length = recv(fd, datagram, sizeof(datagram), 0);
+
+        if (length < HeaderSize) {
+            if (length >= 0) {
+                malformed++;
+            }
+            continue;
+        }
+
+        if (Load<uint16_t>(datagram) != Magic) {
+            malformed++;
+            continue;
+        }
+
+        uint16_t count = Load<uint16_t>(datagram + 2);
+        uint32_t sequence = Load<uint32_t>(datagram + 4);
+        uint32_t counter = Load<uint32_t>(datagram + 8);
+
+        if ((datagrams != 0) && (sequence != expected)) {
+            // Anything in between was lost (or reordered, which on a local network is as good as lost).
+            lost += static_cast<uint32_t>(sequence - expected);
+            fprintf(stderr, "Lost %u datagram(s) before sequence %u\n", static_cast<uint32_t>(sequence - expected), sequence);
+        }
+
+        if (counter != dropped) {
+            // Cumulative, so a lost datagram does not hide the entries dropped before it.
+            fprintf(stderr, "Sender dropped %u entries before sequence %u\n", static_cast<uint32_t>(counter - dropped), sequence);
+            dropped = counter;
+        }
+
+        expected = sequence + 1;
+        datagrams++;
+
+        uint32_t offset = HeaderSize;
+
+        while ((count-- > 0) && ((offset + EntryHeaderSize) <= static_cast<uint32_t>(length))) {
+            uint16_t size = Load<uint16_t>(datagram + offset);
+
+            if ((size < EntryHeaderSize) || ((offset + size) > static_cast<uint32_t>(length)) || (Print(datagram + offset, size) == false)) {
+                malformed++;
+                break;
+            }
+
+            entries++;
+            offset += size;
+        }
+    }
+
+    fprintf(stderr, "Received %llu datagram(s), %llu entries, lost %llu datagram(s), sender dropped %u entries, %llu malformed\n",
+        static_cast<unsigned long long>(datagrams), static_cast<unsigned long long>(entries),
+        static_cast<unsigned long long>(lost), dropped, static_cast<unsigned long long>(malformed));
+
+    close(fd);
+
+    return (0);
+}
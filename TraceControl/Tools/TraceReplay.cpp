@@ -0,0 +1,353 @@
+// Replays synthetic trace sources through the merge of the TraceControl plugin and reports the entries
+// merged per second. The sources hold entries in the layout of the trace cyclic buffers, every entry is
+// copied out and decoded as the plugin does (see TraceControl::Observer::Source). Two merges are timed:
+// the linear rescan of all sources for every entry the plugin used to do, and the heap of loaded sources
+// it does now (see TraceControl::Observer::Worker). Idle sources, processes that do not trace, are what
+// makes the rescan expensive, so the number of active sources can be set apart from the total.
+//
+// Usage: TraceReplay [sources (32)] [active sources (all)] [entries per active source (100000)]
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+static constexpr uint16_t EntryHeaderSize = 2 + 8 + 4;
+static constexpr uint16_t MaxEntrySize = 1024;
+
+class Source {
+public:
+    enum state {
+        EMPTY,
+        LOADED,
+        FAILURE
+    };
+
+public:
+    Source(const std::vector<uint8_t>& data)
+        : _data(data)
+        , _offset(0)
+        , _state(EMPTY)
+        , _information(0)
+    {
+    }
+
+public:
+    // Takes the next entry out of the "buffer" and decodes it, like Source::Load() in the plugin.
+    state Load()
+    {
+        if ((_state == EMPTY) && ((_offset + EntryHeaderSize) <= _data.size())) {
+            const uint16_t length = static_cast<uint16_t>(_data[_offset] | (_data[_offset + 1] << 8));
+
+            if ((length < EntryHeaderSize) || (length > MaxEntrySize) || ((_offset + length) > _data.size())) {
+                _state = FAILURE;
+            } else {
+                ::memcpy(_entry, &(_data[_offset]), length);
+                _offset += length;
+                _state = (Decode(length) == true ? LOADED : FAILURE);
+            }
+        }
+
+        return (_state);
+    }
+    inline state State() const
+    {
+        return (_state);
+    }
+    inline void Clear()
+    {
+        _state = EMPTY;
+    }
+    inline void Flush()
+    {
+        _offset = _data.size();
+        _state = EMPTY;
+    }
+    inline uint64_t Timestamp() const
+    {
+        uint64_t stamp;
+        ::memcpy(&stamp, &(_entry[2]), sizeof(uint64_t));
+        return (stamp);
+    }
+    inline const char* Information() const
+    {
+        return (reinterpret_cast<const char*>(&(_entry[_information])));
+    }
+
+private:
+    bool Decode(const uint16_t length)
+    {
+        const uint8_t* const end = &(_entry[length]);
+        const uint8_t* current = &(_entry[EntryHeaderSize]);
+        uint8_t index = 0;
+
+        // File, module, category and class name, the rest is the information.
+        while ((index < 4) && (current < end)) {
+            const uint8_t* marker = static_cast<const uint8_t*>(::memchr(current, '\0', end - current));
+
+            current = (marker != nullptr ? marker + 1 : end);
+            index += (marker != nullptr ? 1 : 0);
+        }
+
+        _information = static_cast<uint16_t>(current - _entry);
+        _entry[length] = '\0';
+
+        return (index == 4);
+    }
+
+private:
+    const std::vector<uint8_t>& _data;
+    size_t _offset;
+    state _state;
+    uint16_t _information;
+    uint8_t _entry[MaxEntrySize + 1];
+};
+
+// Stands in for the outputs, checks the order and keeps the compiler from skipping the work.
+class Sink {
+public:
+    Sink()
+        : _entries(0)
+        , _last(0)
+        , _unordered(0)
+        , _checksum(0)
+    {
+    }
+
+public:
+    inline void Dispatch(const Source& source)
+    {
+        const uint64_t stamp = source.Timestamp();
+
+        _unordered += (stamp < _last ? 1 : 0);
+        _last = stamp;
+        _checksum += stamp ^ static_cast<uint8_t>(source.Information()[0]);
+        _entries++;
+    }
+    inline uint64_t Entries() const
+    {
+        return (_entries);
+    }
+    inline uint64_t Unordered() const
+    {
+        return (_unordered);
+    }
+    inline uint64_t Checksum() const
+    {
+        return (_checksum);
+    }
+
+private:
+    uint64_t _entries;
+    uint64_t _last;
+    uint64_t _unordered;
+    uint64_t _checksum;
+};
+
+class Later {
+public:
+    inline bool operator()(const Source* lhs, const Source* rhs) const
+    {
+        return (lhs->Timestamp() > rhs->Timestamp());
+    }
+};
+
+// The merge as it was: every source is polled and compared for every entry.
+static void Linear(std::vector<Source*>& sources, Sink& sink)
+{
+    Source* selected;
+
+    do {
+        uint64_t timeStamp = static_cast<uint64_t>(~0);
+
+        selected = nullptr;
+
+        for (Source* source : sources) {
+            Source::state state(source->Load());
+
+            if ((state == Source::LOADED) && (source->Timestamp() < timeStamp)) {
+                timeStamp = source->Timestamp();
+                selected = source;
+            } else if (state == Source::FAILURE) {
+                source->Flush();
+            }
+        }
+
+        if (selected != nullptr) {
+            sink.Dispatch(*selected);
+            selected->Clear();
+        }
+    } while (selected != nullptr);
+}
+
+static void Insert(std::vector<Source*>& heap, Source& source)
+{
+    Source::state state(source.Load());
+
+    if (state == Source::LOADED) {
+        heap.push_back(&source);
+        std::push_heap(heap.begin(), heap.end(), Later());
+    } else if (state == Source::FAILURE) {
+        source.Flush();
+    }
+}
+
+// The merge as it is: only the source that produced the entry is reloaded, the idle ones are polled when
+// the heap runs dry or once every "number of sources" entries.
+static void Heap(std::vector<Source*>& sources, Sink& sink)
+{
+    std::vector<Source*> heap;
+    uint32_t dispatched = 0;
+    bool loaded;
+
+    do {
+        if ((heap.empty() == true) || (dispatched >= sources.size())) {
+            dispatched = 0;
+
+            for (Source* source : sources) {
+                if (source->State() != Source::LOADED) {
+                    Insert(heap, *source);
+                }
+            }
+        }
+
+        loaded = (heap.empty() == false);
+
+        if (loaded == true) {
+            Source* selected = heap.front();
+
+            std::pop_heap(heap.begin(), heap.end(), Later());
+            heap.pop_back();
+
+            sink.Dispatch(*selected);
+
+            selected->Clear();
+            Insert(heap, *selected);
+
+            dispatched++;
+        }
+    } while (loaded == true);
+}
+
+template <typename TYPE>
+static void Store(std::vector<uint8_t>& buffer, const TYPE value)
+{
+    for (uint8_t index = 0; index < sizeof(TYPE); index++) {
+        buffer.push_back(static_cast<uint8_t>(value >> (8 * index)));
+    }
+}
+
+static void Store(std::vector<uint8_t>& buffer, const char text[], const bool terminated)
+{
+    buffer.insert(buffer.end(), text, text + strlen(text) + (terminated == true ? 1 : 0));
+}
+
+// Entries with increasing timestamps, 1us to 2ms apart, and information of a varying length.
+static void Generate(std::vector<uint8_t>& buffer, const uint32_t entries, uint32_t seed)
+{
+    const char* const categories[] = { "Information", "Warning", "Error", "Timing" };
+    uint64_t stamp = 1000000;
+    char information[160];
+
+    for (uint32_t index = 0; index < entries; index++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+
+        stamp += 1 + (seed % 2000);
+        snprintf(information, sizeof(information), "Entry %u of a synthetic source, %.*s", index, static_cast<int>(seed % 96), "........................................................................................................");
+
+        const size_t start = buffer.size();
+
+        Store<uint16_t>(buffer, 0);
+        Store<uint64_t>(buffer, stamp);
+        Store<uint32_t>(buffer, 100 + (seed % 900));
+        Store(buffer, "/usr/src/Thunder/Plugins/Synthetic/Synthetic.cpp", true);
+        Store(buffer, "Plugin_Synthetic", true);
+        Store(buffer, categories[seed % (sizeof(categories) / sizeof(const char*))], true);
+        Store(buffer, "Synthetic::Worker", true);
+        Store(buffer, information, false);
+
+        const uint16_t length = static_cast<uint16_t>(buffer.size() - start);
+
+        buffer[start] = static_cast<uint8_t>(length);
+        buffer[start + 1] = static_cast<uint8_t>(length >> 8);
+    }
+}
+
+static uint64_t Now()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((static_cast<uint64_t>(now.tv_sec) * 1000 * 1000) + (now.tv_nsec / 1000));
+}
+
+template <typename MERGE>
+static bool Run(const char name[], const std::vector<std::vector<uint8_t>>& buffers, MERGE merge, uint64_t& checksum)
+{
+    std::vector<Source*> sources;
+    Sink sink;
+
+    for (const std::vector<uint8_t>& buffer : buffers) {
+        sources.push_back(new Source(buffer));
+    }
+
+    const uint64_t start = Now();
+
+    merge(sources, sink);
+
+    const uint64_t elapsed = Now() - start;
+
+    for (Source* source : sources) {
+        delete source;
+    }
+
+    printf("%-8s %10.0f entries/s (%llu entries in %.3f s)\n", name,
+        (static_cast<double>(sink.Entries()) * 1000 * 1000) / static_cast<double>(elapsed > 0 ? elapsed : 1),
+        static_cast<unsigned long long>(sink.Entries()), static_cast<double>(elapsed) / (1000 * 1000));
+
+    if (sink.Unordered() != 0) {
+        fprintf(stderr, "%s: %llu entries out of order\n", name, static_cast<unsigned long long>(sink.Unordered()));
+    }
+
+    bool result = ((sink.Unordered() == 0) && ((checksum == 0) || (checksum == sink.Checksum())));
+
+    checksum = sink.Checksum();
+
+    return (result);
+}
+
+int main(int argc, char* argv[])
+{
+    const uint32_t sources = (argc > 1 ? atoi(argv[1]) : 32);
+    const uint32_t active = std::min(sources, static_cast<uint32_t>(argc > 2 ? atoi(argv[2]) : sources));
+    const uint32_t entries = (argc > 3 ? atoi(argv[3]) : 100000);
+
+    if ((sources == 0) || (active == 0) || (entries == 0)) {
+        fprintf(stderr, "Usage: %s [sources (32)] [active sources (all)] [entries per active source (100000)]\n", argv[0]);
+        return (1);
+    }
+
+    std::vector<std::vector<uint8_t>> buffers(sources);
+
+    for (uint32_t index = 0; index < active; index++) {
+        Generate(buffers[index], entries, 2463534242u + index);
+    }
+
+    printf("%u sources, %u active, %u entries each\n", sources, active, entries);
+
+    uint64_t checksum = 0;
+    bool result = ((Run("linear", buffers, Linear, checksum) == true) && (Run("heap", buffers, Heap, checksum) == true));
+
+    if (result == false) {
+        fprintf(stderr, "The merges do not agree\n");
+    }
+
+    return (result == true ? 0 : 1);
+}
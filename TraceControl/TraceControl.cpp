@@ -1,5 +1,4 @@
 #include "TraceControl.h"
-#include "TraceOutput.h"
 
 namespace WPEFramework {
 
@@ -19,6 +18,22 @@ namespace Plugin {
     /* static */ TraceControl::Observer::Source::LocalIterator TraceControl::Observer::Source::_localIterator;
     static Core::ProxyPoolType<Web::JSONBodyType<TraceControl::Data>> jsonBodyDataFactory(4);
 
+    // Only plain decimal numbers that fit are accepted, NumberType would quietly read anything else as 0.
+    static bool Number(const string& text, uint32_t& value)
+    {
+        uint64_t result = 0;
+        string::const_iterator index(text.begin());
+
+        while ((index != text.end()) && (*index >= '0') && (*index <= '9') && (result <= 0xFFFFFFFF)) {
+            result = (result * 10) + (*index - '0');
+            index++;
+        }
+
+        value = static_cast<uint32_t>(result);
+
+        return ((text.empty() == false) && (index == text.end()) && (result <= 0xFFFFFFFF));
+    }
+
     /* static */ string TraceControl::Observer::Source::SourceName(const string& prefix, RPC::IRemoteConnection* connection)
     {
         string pathName;
@@ -39,6 +54,9 @@ namespace Plugin {
     {
         ASSERT(_service == nullptr);
         ASSERT(_outputs.size() == 0);
+        ASSERT(_localOutputs.size() == 0);
+        ASSERT(_remote == nullptr);
+        ASSERT(_recorder == nullptr);
 
         _service = service;
         _config.FromString(_service->ConfigLine());
@@ -53,15 +71,26 @@ namespace Plugin {
         _skipURL = static_cast<uint8_t>(_service->WebPrefix().length());
 
         if (((service->Background() == false) && (_config.Console.IsSet() == false) && (_config.SysLog.IsSet() == false)) || ((_config.Console.IsSet() == true) && (_config.Console.Value() == true))) {
-            _outputs.push_back(new Plugin::TraceOutput(false));
+            _localOutputs.push_back(new Plugin::TraceOutput(false));
         }
         if (((service->Background() == true) && (_config.Console.IsSet() == false) && (_config.SysLog.IsSet() == false)) || ((_config.SysLog.IsSet() == true) && (_config.SysLog.Value() == true))) {
-            _outputs.push_back(new Plugin::TraceOutput(true));
+            _localOutputs.push_back(new Plugin::TraceOutput(true));
         }
         if (_config.Remote.IsSet() == true) {
             Core::NodeId logNode(_config.Remote.Binding.Value().c_str(), _config.Remote.Port.Value());
 
-            _outputs.push_back(new Trace::TraceMedia(logNode));
+            if (_config.Remote.MTU.IsSet() == true) {
+                // Batched mode, pack as many entries as fit in a datagram of the given size.
+                _remote = new Plugin::TraceRemote(logNode, _config.Remote.MTU.Value(), _config.Remote.Latency.Value());
+            } else {
+                _outputs.push_back(new Trace::TraceMedia(logNode));
+            }
+        }
+
+        _streams.Configure(_config.Subscribers.Value(), _config.Pending.Value());
+
+        if (_config.Recorder.IsSet() == true) {
+            _recorder = new Plugin::TraceRecorder(_service->VolatilePath(), _config.Recorder.Size.Value() * 1024, _config.Recorder.Files.Value());
         }
 
         _service->Register(&_observer);
@@ -87,6 +116,29 @@ namespace Plugin {
 
             _outputs.pop_front();
         }
+        while (_localOutputs.size() != 0) {
+            delete _localOutputs.front();
+
+            _localOutputs.pop_front();
+        }
+        if (_remote != nullptr) {
+            delete _remote;
+            _remote = nullptr;
+        }
+        if (_recorder != nullptr) {
+            delete _recorder;
+            _recorder = nullptr;
+        }
+    }
+
+    /* virtual */ bool TraceControl::Attach(PluginHost::Channel& channel)
+    {
+        return (_streams.Attach(channel));
+    }
+
+    /* virtual */ void TraceControl::Detach(PluginHost::Channel& channel)
+    {
+        _streams.Detach(channel);
     }
 
     /* virtual */ string TraceControl::Information() const
@@ -104,6 +156,8 @@ namespace Plugin {
     // <PUT> ../[on,off]
     // <PUT> ../<ModuleName>/[on,off]
     // <PUT> ../<ModuleName>/<CategoryName>/[on,off]
+    // <PUT> ../<ModuleName>/<CategoryName>/rate/<TracesPerSecond>[/<Burst>]
+    // <PUT> ../<ModuleName>/<CategoryName>/sample/<N>
     /* virtual */ Core::ProxyType<Web::Response> TraceControl::Process(const Web::Request& request)
     {
         ASSERT(_skipURL <= request.Path.length());
@@ -124,6 +178,26 @@ namespace Plugin {
             response->Console = _config.Console;
             response->Remote = _config.Remote;
 
+            std::list<TraceOutput*>::const_iterator output(_localOutputs.begin());
+            uint32_t written = 0, dropped = 0, overflows = 0;
+
+            while (output != _localOutputs.end()) {
+                written += (*output)->Written();
+                dropped += (*output)->Dropped();
+                overflows += (*output)->Overflows();
+                output++;
+            }
+
+            response->Output.Written = written;
+            response->Output.Dropped = dropped;
+            response->Output.Overflows = overflows;
+
+            if (_remote != nullptr) {
+                response->Forwarded.Sent = _remote->Sent();
+                response->Forwarded.Dropped = _remote->Dropped();
+                response->Forwarded.Lost = _remote->Lost();
+            }
+
             Observer::ModuleIterator index(_observer.Modules());
 
             while (index.Next() == true) {
@@ -134,7 +208,14 @@ namespace Plugin {
                 while (categories.Next()) {
                     string categoryName(Core::ToString(categories.Category()));
 
-                    response->Settings.Add(Data::Trace(moduleName, categoryName, categories.State()));
+                    Data::Trace trace(moduleName, categoryName, categories.State());
+                    uint32_t suppressed = _throttle.Suppressed(moduleName, categoryName);
+
+                    if (suppressed != 0) {
+                        trace.Suppressed = suppressed;
+                    }
+
+                    response->Settings.Add(trace);
                 }
             }
 
@@ -167,9 +248,31 @@ namespace Plugin {
                                     (index.Current() == _T("on")),
                                     (moduleName.length() != 0 ? moduleName : std::string(EMPTY_STRING)),
                                     (categoryName.length() != 0 ? categoryName : std::string(EMPTY_STRING)));
+                            } else if ((index.Current() == _T("rate")) || (index.Current() == _T("sample"))) {
+                                // Setting the one keeps the other as it was.
+                                const bool isRate = (index.Current() == _T("rate"));
+                                uint32_t rate, burst, sample, value = 0;
+                                bool valid = ((index.Next() == true) && (Number(index.Current().Text(), value) == true));
+
+                                Throttled(moduleName, categoryName, rate, burst, sample);
+
+                                if (isRate == true) {
+                                    rate = value;
+                                    burst = 0;
+                                    valid = ((valid == true) && ((index.Next() == false) || (Number(index.Current().Text(), burst) == true)));
+                                } else {
+                                    sample = value;
+                                }
+
+                                if (valid == true) {
+                                    Throttle(moduleName, categoryName, rate, burst, sample);
+                                } else {
+                                    result->ErrorCode = Web::STATUS_BAD_REQUEST;
+                                    result->Message = _T(" could not handle your request, rate/<value>[/<burst>] and sample/<value> take decimal numbers.");
+                                }
                             } else {
                                 result->ErrorCode = Web::STATUS_BAD_REQUEST;
-                                result->Message = _T(" could not handle your request, last parameter should be [on,off].");
+                                result->Message = _T(" could not handle your request, last parameter should be [on,off], rate/<value> or sample/<value>.");
                             }
                         } else {
                             result->ErrorCode = Web::STATUS_BAD_REQUEST;
@@ -194,15 +297,54 @@ namespace Plugin {
         return (result);
     }
 
+    /* virtual */ uint32_t TraceControl::Inbound(const uint32_t ID, const uint8_t data[], const uint16_t length)
+    {
+        return (_streams.Inbound(ID, data, length));
+    }
+
+    /* virtual */ uint32_t TraceControl::Outbound(const uint32_t ID, uint8_t data[], const uint16_t length) const
+    {
+        return (_streams.Outbound(ID, data, length));
+    }
+
     void TraceControl::Dispatch(Observer::Source& information)
     {
-        std::list<Trace::ITraceMedia*>::iterator index(_outputs.begin());
-        InformationWrapper wrapper(information);
+        // Rate limiting/sampling is decided before any of the outputs spends time on this entry.
+        if (_throttle.Allow(information.Timestamp(), information.Module(), information.Category()) == true) {
+            std::list<TraceOutput*>::iterator local(_localOutputs.begin());
+            std::list<Trace::ITraceMedia*>::iterator index(_outputs.begin());
+            InformationWrapper wrapper(information);
+
+            while (local != _localOutputs.end()) {
+                (*local)->Output(information.Timestamp(), information.FileName(), information.LineNumber(), information.ClassName(), &wrapper);
+                local++;
+            }
+            if (_remote != nullptr) {
+                _remote->Output(information.Timestamp(), information.FileName(), information.LineNumber(), information.ClassName(), &wrapper);
+            }
+            if (_recorder != nullptr) {
+                _recorder->Output(information.Timestamp(), information.FileName(), information.LineNumber(), information.ClassName(), &wrapper);
+            }
+            while (index != _outputs.end()) {
+                (*index)->Output(information.FileName(), information.LineNumber(), information.ClassName(), &wrapper);
+                index++;
+            }
 
-        while (index != _outputs.end()) {
-            (*index)->Output(information.FileName(), information.LineNumber(), information.ClassName(), &wrapper);
-            index++;
+            _streams.Output(information.Timestamp(), information.FileName(), information.LineNumber(), &wrapper);
         }
     }
+
+    void TraceControl::Throttle(const string& module, const string& category, const uint32_t rate, const uint32_t burst, const uint32_t sample)
+    {
+        TRACE(Trace::Information, (_T("Throttle %s/%s: rate %d, burst %d, sample 1 in %d"), module.c_str(), category.c_str(), rate, burst, sample));
+
+        // A category of "*" sets the limit for all categories of the module.
+        _throttle.Set(module, (category == _T("*") ? string(EMPTY_STRING) : category), rate, burst, sample);
+    }
+
+    void TraceControl::Throttled(const string& module, const string& category, uint32_t& rate, uint32_t& burst, uint32_t& sample) const
+    {
+        _throttle.Get(module, (category == _T("*") ? string(EMPTY_STRING) : category), rate, burst, sample);
+    }
 }
 }
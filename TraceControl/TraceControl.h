@@ -1,13 +1,18 @@
 #pragma once
 
 #include "Module.h"
+#include "TraceOutput.h"
+#include "TraceRecorder.h"
+#include "TraceRemote.h"
+#include "TraceStream.h"
+#include "TraceThrottle.h"
 #include <interfaces/json/JsonData_TraceControl.h>
 
 namespace WPEFramework {
 
 namespace Plugin {
 
-    class TraceControl : public PluginHost::IPlugin, public PluginHost::IWeb, public PluginHost::JSONRPC {
+    class TraceControl : public PluginHost::IPluginExtended, public PluginHost::IWeb, public PluginHost::IChannel, public PluginHost::JSONRPC {
 
     public:
         enum state {
@@ -98,6 +103,9 @@ namespace Plugin {
                     FAILURE
                 };
 
+                // Lag between producing and dispatching an entry, in decades: <10us, <100us, ... <10s, >=10s
+                static constexpr uint8_t LagBuckets = 8;
+
             public:
                 Source(const string& tracePath, RPC::IRemoteConnection* connection)
                     : Core::CyclicBuffer(SourceName(tracePath, connection), 0, true)
@@ -108,8 +116,16 @@ namespace Plugin {
                     , _category(0)
                     , _classname(0)
                     , _information()
+                    , _length(0)
                     , _state(EMPTY)
+                    , _traceBuffer(nullptr)
+                    , _entries(0)
+                    , _bytes(0)
+                    , _failures(0)
+                    , _maxLag(0)
                 {
+                    ::memset(_lag, 0, sizeof(_lag));
+
                     if (_connection != nullptr) {
                         TRACE_L1("Constructing TraceControl::Source (%d)", connection->Id());
                         _connection->AddRef();
@@ -126,6 +142,9 @@ namespace Plugin {
                         _connection->Release();
                         _connection = nullptr;
                     }
+                    if (_traceBuffer != nullptr) {
+                        delete[] _traceBuffer;
+                    }
                 }
 
             public:
@@ -187,9 +206,15 @@ namespace Plugin {
                 {
                     uint32_t length;
 
+                    // Only claim the entry storage once this process actually produced a trace. Most of the
+                    // processes never trace at all and should not cost a full CyclicBufferSize worth of memory.
+                    if ((_traceBuffer == nullptr) && (_state == EMPTY) && (Used() > 0)) {
+                        _traceBuffer = new uint8_t[Trace::CyclicBufferSize + 1];
+                    }
+
                     // Traces will be commited in one go, First reserve, then write. So if there is a length (2 bytes)
                     // The full trace has to be available as well.
-                    if ((_state == EMPTY) && ((length = Read(_traceBuffer, sizeof(_traceBuffer))) != 0)) {
+                    if ((_state == EMPTY) && (_traceBuffer != nullptr) && ((length = Read(_traceBuffer, Trace::CyclicBufferSize)) != 0)) {
 
                         if (length < 2) {
                             // Didn't even get enough data to read entry size. This is impossible, fallback to failure.
@@ -199,39 +224,14 @@ namespace Plugin {
                             // TODO: This is platform dependend, needs to ba agnostic to the platform.
                             uint16_t requiredLength = (_traceBuffer[1] << 8) | _traceBuffer[0];
 
-                            if (requiredLength != length) {
+                            if ((requiredLength != length) || (Decode(requiredLength) == false)) {
                                 // Something went wrong, didn't read a full entry.
                                 _state = FAILURE;
                             } else {
-                                // length(2 bytes) - clock ticks (8 bytes) - line number (4 bytes) - file/module/category/className
-
-                                // Keep track of location in buffer.
-                                uint32_t offset = /* length */ 2 /* clock */ + 8 /* Skip line number */ + 4;
-
-                                // Skip file name.
-                                offset += static_cast<uint32_t>(strlen(reinterpret_cast<char*>(_traceBuffer + offset)) + 1);
-
-                                // Get module offset.
-                                _module = offset;
-                                offset += static_cast<uint32_t>(strlen(reinterpret_cast<char*>(_traceBuffer + _module)) + 1);
-
-                                // Get category offset.
-                                _category = offset;
-                                offset += static_cast<uint32_t>(strlen(reinterpret_cast<char*>(_traceBuffer + _category)) + 1);
-
-                                // Get class name offset.
-                                _classname = offset;
-                                offset += static_cast<uint32_t>(strlen(reinterpret_cast<char*>(_traceBuffer + _classname)) + 1);
-
-                                ASSERT(length >= offset);
-
-                                // Rest of entry is information.
-                                _information = offset;
-                                _length = requiredLength - offset;
-                                _traceBuffer[requiredLength] = '\0';
-
                                 // Entries are read in whole, so we are done.
                                 _state = LOADED;
+                                _entries++;
+                                _bytes += requiredLength;
                             }
                         }
                     }
@@ -280,14 +280,88 @@ namespace Plugin {
                 void Flush()
                 {
                     _state = EMPTY;
+                    _failures++;
                     Core::CyclicBuffer::Flush();
                 }
+                // Register the moment the loaded entry got dispatched.
+                void Dispatched(const uint64_t now)
+                {
+                    uint64_t lag = (now > Timestamp() ? now - Timestamp() : 0);
+                    uint64_t limit = 10;
+                    uint8_t bucket = 0;
+
+                    while ((bucket < (LagBuckets - 1)) && (lag >= limit)) {
+                        limit *= 10;
+                        bucket++;
+                    }
+
+                    _lag[bucket]++;
+
+                    if (lag > _maxLag) {
+                        _maxLag = lag;
+                    }
+                }
+                inline uint32_t Entries() const
+                {
+                    return (_entries);
+                }
+                inline uint64_t Bytes() const
+                {
+                    return (_bytes);
+                }
+                inline uint32_t Failures() const
+                {
+                    return (_failures);
+                }
+                inline uint64_t MaxLag() const
+                {
+                    return (_maxLag);
+                }
+                inline uint32_t Lag(const uint8_t bucket) const
+                {
+                    ASSERT(bucket < LagBuckets);
+
+                    return (_lag[bucket]);
+                }
                 void Clear()
                 {
                     _state = EMPTY;
                 }
 
             private:
+                // length(2 bytes) - clock ticks (8 bytes) - line number (4 bytes) - file/module/category/className - information
+                // Locates all strings in a single pass, bounded by the entry length, so a corrupted entry can never
+                // make us run past the data that was actually read.
+                bool Decode(const uint16_t length)
+                {
+                    const uint8_t* const end = &(_traceBuffer[length]);
+                    const uint8_t* current = &(_traceBuffer[/* length */ 2 /* clock */ + 8 /* line number */ + 4]);
+                    uint16_t* const offsets[] = { nullptr /* file */, &_module, &_category, &_classname };
+                    uint8_t index = 0;
+
+                    while ((index < (sizeof(offsets) / sizeof(uint16_t*))) && (current < end)) {
+                        const uint8_t* marker = static_cast<const uint8_t*>(::memchr(current, '\0', end - current));
+
+                        if (marker != nullptr) {
+                            if (offsets[index] != nullptr) {
+                                *(offsets[index]) = static_cast<uint16_t>(current - _traceBuffer);
+                            }
+                            current = marker + 1;
+                            index++;
+                        } else {
+                            current = end;
+                        }
+                    }
+
+                    if (index == (sizeof(offsets) / sizeof(uint16_t*))) {
+                        // Rest of entry is information.
+                        _information = static_cast<uint16_t>(current - _traceBuffer);
+                        _length = length - _information;
+                        _traceBuffer[length] = '\0';
+                    }
+
+                    return (index == (sizeof(offsets) / sizeof(uint16_t*)));
+                }
                 virtual uint32_t GetReadSize(Core::CyclicBuffer::Cursor& cursor) override
                 {
                     // Just read one entry.
@@ -305,7 +379,12 @@ namespace Plugin {
                 uint16_t _information;
                 uint16_t _length;
                 state _state;
-                uint8_t _traceBuffer[Trace::CyclicBufferSize];
+                uint8_t* _traceBuffer;
+                uint32_t _entries;
+                uint64_t _bytes;
+                uint32_t _failures;
+                uint64_t _maxLag;
+                uint32_t _lag[LagBuckets];
                 static LocalIterator _localIterator;
             };
 
@@ -528,10 +607,22 @@ namespace Plugin {
                 ModuleMapIterator _iterator;
             };
 
+        private:
+            // Orders the heap of loaded sources, the source with the oldest entry ends up on top.
+            class Later {
+            public:
+                inline bool operator()(const Source* lhs, const Source* rhs) const
+                {
+                    return (lhs->Timestamp() > rhs->Timestamp());
+                }
+            };
+
         public:
             Observer(TraceControl& parent)
                 : Thread(Core::Thread::DefaultStackSize(), _T("TraceWorker"))
                 , _buffers()
+                , _heap()
+                , _dispatched(0)
                 , _traceControl(Trace::TraceUnit::Instance())
                 , _parent(parent)
                 , _refcount(0)
@@ -565,6 +656,8 @@ namespace Plugin {
 
                 _adminLock.Lock();
 
+                _heap.clear();
+
                 while (_buffers.size() != 0) {
                     delete _buffers.begin()->second;
 
@@ -591,6 +684,7 @@ namespace Plugin {
                 std::map<const uint32_t, Source*>::iterator index(_buffers.find(connection->Id()));
 
                 if (index != _buffers.end()) {
+                    Remove(index->second);
                     delete (index->second);
                     _buffers.erase(index);
                 }
@@ -631,6 +725,21 @@ namespace Plugin {
                 return (ModuleIterator(_buffers));
             }
 
+            template <typename ACTION>
+            void Visit(ACTION action) const
+            {
+                _adminLock.Lock();
+
+                std::map<const uint32_t, Source*>::const_iterator index(_buffers.begin());
+
+                while (index != _buffers.end()) {
+                    action(*(index->second));
+                    index++;
+                }
+
+                _adminLock.Unlock();
+            }
+
         private:
             BEGIN_INTERFACE_MAP(Observer)
             INTERFACE_ENTRY(RPC::IRemoteConnection::INotification)
@@ -648,68 +757,92 @@ namespace Plugin {
             }
             virtual uint32_t Worker()
             {
-                
                 while ((IsRunning() == true) && (_traceControl.Wait(Core::infinite) == Core::ERROR_NONE)) {
                     // Before we start we reset the flag, if new info is coming in, we will get a retrigger flag.
                     _traceControl.Acknowledge();
 
-                    Source* selected;
-
-                    uint64_t timeStamp;
+                    bool loaded;
 
                     do {
-                        selected = nullptr;
-
                         _adminLock.Lock();
 
-                        timeStamp = static_cast<uint64_t>(~0);
+                        // Only the sources that are not already waiting in the heap need to be polled, the
+                        // heap holds the sources that have an entry loaded, sorted on the timestamp.
+                        Collect();
 
-                        std::map<const uint32_t, Source*>::iterator index(_buffers.begin());
+                        loaded = (_heap.empty() == false);
 
-                        while (index != _buffers.end()) {
+                        if (loaded == true) {
+                            Source* selected = _heap.front();
 
-                            Source::state state(index->second->Load());
+                            std::pop_heap(_heap.begin(), _heap.end(), Later());
+                            _heap.pop_back();
 
-                            if (state == Source::LOADED) {
-                                if (index->second->Timestamp() < timeStamp) {
-                                    timeStamp = index->second->Timestamp();
-
-                                    if (state == Source::LOADED) {
-                                        selected = index->second;
-                                    }
-                                }
-                            } else if (state == Source::FAILURE) {
-                                // Oops this requires recovery, so let's flush
-                                index->second->Flush();
-                            }
-
-                            index++;
-                        }
-
-                        if (selected != nullptr) {
+                            selected->Dispatched(Core::Time::Now().Ticks());
 
                             // Oke, output this entry
                             _parent.Dispatch(*selected);
 
-                            // Ready to load a new one..
+                            // Ready to load a new one, if it is there, it goes straight back into the heap..
                             selected->Clear();
-                        } else if (timeStamp != static_cast<uint64_t>(~0)) {
-                            // Looks like we are waiting for a message to be completed.
-                            // Give up our slice, so the producer, can produce.
-                            ::SleepMs(0);
+                            Insert(*selected);
+
+                            _dispatched++;
                         }
 
                         _adminLock.Unlock();
 
-                    } while ((IsRunning() == true) && (timeStamp != static_cast<uint64_t>(~0)));
+                    } while ((IsRunning() == true) && (loaded == true));
                 }
 
                 return (Core::infinite);
             }
+            void Collect()
+            {
+                // Rescanning the idle sources is O(number of sources), so only do it if the heap ran dry
+                // or once every "number of sources" dispatched entries, which keeps the cost per entry
+                // constant and still guarantees an idle source gets picked up within a bounded delay.
+                if ((_heap.empty() == true) || (_dispatched >= _buffers.size())) {
+
+                    _dispatched = 0;
+
+                    std::map<const uint32_t, Source*>::iterator index(_buffers.begin());
+
+                    while (index != _buffers.end()) {
+                        if (index->second->State() != Source::LOADED) {
+                            Insert(*(index->second));
+                        }
+                        index++;
+                    }
+                }
+            }
+            void Insert(Source& source)
+            {
+                Source::state state(source.Load());
+
+                if (state == Source::LOADED) {
+                    _heap.push_back(&source);
+                    std::push_heap(_heap.begin(), _heap.end(), Later());
+                } else if (state == Source::FAILURE) {
+                    // Oops this requires recovery, so let's flush
+                    source.Flush();
+                }
+            }
+            void Remove(const Source* source)
+            {
+                std::vector<Source*>::iterator index(std::find(_heap.begin(), _heap.end(), source));
+
+                if (index != _heap.end()) {
+                    _heap.erase(index);
+                    std::make_heap(_heap.begin(), _heap.end(), Later());
+                }
+            }
 
         private:
-            Core::CriticalSection _adminLock;
+            mutable Core::CriticalSection _adminLock;
             std::map<const uint32_t, Source*> _buffers;
+            std::vector<Source*> _heap;
+            uint32_t _dispatched;
             Trace::TraceUnit& _traceControl;
             TraceControl& _parent;
             mutable uint32_t _refcount;
@@ -759,17 +892,25 @@ namespace Plugin {
                 : Core::JSON::Container()
                 , Port(2200)
                 , Binding("0.0.0.0")
+                , MTU(1400)
+                , Latency(50)
             {
                 Add(_T("port"), &Port);
                 Add(_T("binding"), &Binding);
+                Add(_T("mtu"), &MTU);
+                Add(_T("latency"), &Latency);
             }
             NetworkNode(const NetworkNode& copy)
                 : Core::JSON::Container()
                 , Port(copy.Port)
                 , Binding(copy.Binding)
+                , MTU(copy.MTU)
+                , Latency(copy.Latency)
             {
                 Add(_T("port"), &Port);
                 Add(_T("binding"), &Binding);
+                Add(_T("mtu"), &MTU);
+                Add(_T("latency"), &Latency);
             }
             ~NetworkNode()
             {
@@ -779,6 +920,8 @@ namespace Plugin {
             {
                 Port = RHS.Port;
                 Binding = RHS.Binding;
+                MTU = RHS.MTU;
+                Latency = RHS.Latency;
 
                 return (*this);
             }
@@ -786,6 +929,30 @@ namespace Plugin {
         public:
             Core::JSON::DecUInt16 Port;
             Core::JSON::String Binding;
+            Core::JSON::DecUInt16 MTU; // If set, entries are batched in datagrams of at most this size
+            Core::JSON::DecUInt16 Latency; // Max time (ms) an entry waits for its datagram to fill up
+        };
+        class RecorderNode : public Core::JSON::Container {
+        private:
+            RecorderNode(const RecorderNode&) = delete;
+            RecorderNode& operator=(const RecorderNode&) = delete;
+
+        public:
+            RecorderNode()
+                : Core::JSON::Container()
+                , Size(1024)
+                , Files(4)
+            {
+                Add(_T("size"), &Size);
+                Add(_T("files"), &Files);
+            }
+            ~RecorderNode()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 Size; // Size of a single recording file in KB
+            Core::JSON::DecUInt8 Files; // Number of files in the ring
         };
         class Config : public Core::JSON::Container {
         private:
@@ -798,10 +965,16 @@ namespace Plugin {
                 , Console(false)
                 , SysLog(true)
                 , Remote()
+                , Recorder()
+                , Subscribers(4)
+                , Pending(64 * 1024)
             {
                 Add(_T("console"), &Console);
                 Add(_T("syslog"), &SysLog);
                 Add(_T("remote"), &Remote);
+                Add(_T("recorder"), &Recorder);
+                Add(_T("subscribers"), &Subscribers);
+                Add(_T("pending"), &Pending);
             }
             ~Config()
             {
@@ -811,6 +984,9 @@ namespace Plugin {
             Core::JSON::Boolean Console;
             Core::JSON::Boolean SysLog;
             NetworkNode Remote;
+            RecorderNode Recorder;
+            Core::JSON::DecUInt8 Subscribers; // Max number of WebSocket channels streaming traces
+            Core::JSON::DecUInt32 Pending; // Max bytes queued per WebSocket channel, before entries get dropped
         };
         class Data : public Core::JSON::Container {
         public:
@@ -844,6 +1020,7 @@ namespace Plugin {
                     Add(_T("module"), &Module);
                     Add(_T("category"), &Category);
                     Add(_T("state"), &State);
+                    Add(_T("suppressed"), &Suppressed);
                 }
                 Trace(const string& moduleName, const string& categoryName, const state currentState)
                     : Core::JSON::Container()
@@ -851,6 +1028,7 @@ namespace Plugin {
                     Add(_T("module"), &Module);
                     Add(_T("category"), &Category);
                     Add(_T("state"), &State);
+                    Add(_T("suppressed"), &Suppressed);
 
                     Module = moduleName;
                     Category = categoryName;
@@ -861,10 +1039,12 @@ namespace Plugin {
                     , Module(copy.Module)
                     , Category(copy.Category)
                     , State(copy.State)
+                    , Suppressed(copy.Suppressed)
                 {
                     Add(_T("module"), &Module);
                     Add(_T("category"), &Category);
                     Add(_T("state"), &State);
+                    Add(_T("suppressed"), &Suppressed);
                 }
                 ~Trace()
                 {
@@ -874,6 +1054,213 @@ namespace Plugin {
                 Core::JSON::String Module;
                 Core::JSON::String Category;
                 Core::JSON::EnumType<state> State;
+                Core::JSON::DecUInt32 Suppressed; // Traces dropped by the rate limit/sampling of this category
+            };
+
+            class Throttle : public Core::JSON::Container {
+            private:
+                Throttle& operator=(const Throttle&);
+
+            public:
+                Throttle()
+                    : Core::JSON::Container()
+                {
+                    Init();
+                }
+                Throttle(const TraceThrottle::Limit& limit)
+                    : Core::JSON::Container()
+                {
+                    Init();
+
+                    Module = limit.Module();
+                    Category = (limit.Category().empty() == true ? string(_T("*")) : limit.Category());
+                    Rate = limit.Rate();
+                    Burst = limit.Burst();
+                    Sample = limit.Sample();
+                    Suppressed = limit.Suppressed();
+                }
+                Throttle(const Throttle& copy)
+                    : Core::JSON::Container()
+                    , Module(copy.Module)
+                    , Category(copy.Category)
+                    , Rate(copy.Rate)
+                    , Burst(copy.Burst)
+                    , Sample(copy.Sample)
+                    , Suppressed(copy.Suppressed)
+                {
+                    Init();
+                }
+                ~Throttle()
+                {
+                }
+
+            private:
+                void Init()
+                {
+                    Add(_T("module"), &Module);
+                    Add(_T("category"), &Category);
+                    Add(_T("rate"), &Rate);
+                    Add(_T("burst"), &Burst);
+                    Add(_T("sample"), &Sample);
+                    Add(_T("suppressed"), &Suppressed);
+                }
+
+            public:
+                Core::JSON::String Module; // Module name
+                Core::JSON::String Category; // Category name, "*" for all categories of the module
+                Core::JSON::DecUInt32 Rate; // Traces per second, 0 is unlimited
+                Core::JSON::DecUInt32 Burst; // Traces that can be sent in a burst
+                Core::JSON::DecUInt32 Sample; // Only 1 in every N traces is sent, 0 or 1 sends all
+                Core::JSON::DecUInt32 Suppressed; // Traces dropped by this limit
+            };
+
+            class Statistics : public Core::JSON::Container {
+            private:
+                Statistics(const Statistics&) = delete;
+                Statistics& operator=(const Statistics&) = delete;
+
+            public:
+                Statistics()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("written"), &Written);
+                    Add(_T("dropped"), &Dropped);
+                    Add(_T("overflows"), &Overflows);
+                }
+                ~Statistics()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Written; // Lines handed over to the console/syslog
+                Core::JSON::DecUInt32 Dropped; // Lines lost as the output queue was full
+                Core::JSON::DecUInt32 Overflows; // Number of times the output queue ran full
+            };
+
+            class Forwarding : public Core::JSON::Container {
+            private:
+                Forwarding(const Forwarding&) = delete;
+                Forwarding& operator=(const Forwarding&) = delete;
+
+            public:
+                Forwarding()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("sent"), &Sent);
+                    Add(_T("dropped"), &Dropped);
+                    Add(_T("lost"), &Lost);
+                }
+                ~Forwarding()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Sent; // Datagrams sent to the remote collector
+                Core::JSON::DecUInt32 Dropped; // Entries that never made it into a datagram
+                Core::JSON::DecUInt32 Lost; // Datagrams that could not be sent
+            };
+
+            class Source : public Core::JSON::Container {
+            public:
+                class Bucket : public Core::JSON::Container {
+                private:
+                    Bucket& operator=(const Bucket&);
+
+                public:
+                    Bucket()
+                        : Core::JSON::Container()
+                    {
+                        Add(_T("limit"), &Limit);
+                        Add(_T("count"), &Count);
+                    }
+                    Bucket(const uint64_t limit, const uint32_t count)
+                        : Core::JSON::Container()
+                    {
+                        Add(_T("limit"), &Limit);
+                        Add(_T("count"), &Count);
+
+                        if (limit != 0) {
+                            Limit = limit;
+                        }
+                        Count = count;
+                    }
+                    Bucket(const Bucket& copy)
+                        : Core::JSON::Container()
+                        , Limit(copy.Limit)
+                        , Count(copy.Count)
+                    {
+                        Add(_T("limit"), &Limit);
+                        Add(_T("count"), &Count);
+                    }
+                    ~Bucket()
+                    {
+                    }
+
+                public:
+                    Core::JSON::DecUInt64 Limit; // Upper bound (us) of the lag in this bucket, absent for the last one
+                    Core::JSON::DecUInt32 Count;
+                };
+
+            private:
+                Source& operator=(const Source&);
+
+            public:
+                Source()
+                    : Core::JSON::Container()
+                {
+                    Init();
+                }
+                Source(const Observer::Source& source)
+                    : Core::JSON::Container()
+                {
+                    Init();
+
+                    Id = source.Id();
+                    Entries = source.Entries();
+                    Bytes = source.Bytes();
+                    Failures = source.Failures();
+                    MaxLag = source.MaxLag();
+
+                    uint64_t limit = 10;
+
+                    for (uint8_t bucket = 0; bucket < Observer::Source::LagBuckets; bucket++) {
+                        Lag.Add(Bucket((bucket < (Observer::Source::LagBuckets - 1) ? limit : 0), source.Lag(bucket)));
+                        limit *= 10;
+                    }
+                }
+                Source(const Source& copy)
+                    : Core::JSON::Container()
+                    , Id(copy.Id)
+                    , Entries(copy.Entries)
+                    , Bytes(copy.Bytes)
+                    , Failures(copy.Failures)
+                    , MaxLag(copy.MaxLag)
+                    , Lag(copy.Lag)
+                {
+                    Init();
+                }
+                ~Source()
+                {
+                }
+
+            private:
+                void Init()
+                {
+                    Add(_T("id"), &Id);
+                    Add(_T("entries"), &Entries);
+                    Add(_T("bytes"), &Bytes);
+                    Add(_T("failures"), &Failures);
+                    Add(_T("maxlag"), &MaxLag);
+                    Add(_T("lag"), &Lag);
+                }
+
+            public:
+                Core::JSON::DecUInt32 Id; // Connection id of the process, 0 is WPEFramework itself
+                Core::JSON::DecUInt32 Entries; // Entries consumed
+                Core::JSON::DecUInt64 Bytes; // Bytes consumed
+                Core::JSON::DecUInt32 Failures; // Inconsistent reads that required a flush of the buffer
+                Core::JSON::DecUInt64 MaxLag; // Highest lag (us) between producing and dispatching an entry
+                Core::JSON::ArrayType<Bucket> Lag; // Lag histogram
             };
 
         private:
@@ -887,6 +1274,8 @@ namespace Plugin {
                 Add(_T("console"), &Console);
                 Add(_T("remote"), &Remote);
                 Add(_T("settings"), &Settings);
+                Add(_T("output"), &Output);
+                Add(_T("forwarded"), &Forwarded);
             }
             ~Data()
             {
@@ -896,6 +1285,8 @@ namespace Plugin {
             Core::JSON::Boolean Console;
             NetworkNode Remote;
             Core::JSON::ArrayType<Trace> Settings;
+            Statistics Output;
+            Forwarding Forwarded; // Only if a remote collector is configured
         };
 
     public:
@@ -906,6 +1297,11 @@ namespace Plugin {
             : _skipURL(0)
             , _service(nullptr)
             , _outputs()
+            , _localOutputs()
+            , _remote(nullptr)
+            , _recorder(nullptr)
+            , _throttle()
+            , _streams()
             , _tracePath()
             , _observer(*this)
         {
@@ -921,12 +1317,14 @@ namespace Plugin {
 
         BEGIN_INTERFACE_MAP(TraceControl)
         INTERFACE_ENTRY(PluginHost::IPlugin)
+        INTERFACE_ENTRY(PluginHost::IPluginExtended)
         INTERFACE_ENTRY(PluginHost::IWeb)
+        INTERFACE_ENTRY(PluginHost::IChannel)
         INTERFACE_ENTRY(PluginHost::IDispatcher)
         END_INTERFACE_MAP
 
     public:
-        //  IPlugin methods
+        //  IPluginExtended methods
         // -------------------------------------------------------------------------------------------------------
 
         // First time initialization. Whenever a plugin is loaded, it is offered a Service object with relevant
@@ -943,6 +1341,11 @@ namespace Plugin {
         // After theis call, the lifetime of the Service object ends.
         virtual void Deinitialize(PluginHost::IShell* service);
 
+        // Whenever a Channel (WebSocket connection) is created to the plugin that will be reported via the Attach.
+        // Whenever the channel is closed, it is reported via the detach method.
+        virtual bool Attach(PluginHost::Channel& channel);
+        virtual void Detach(PluginHost::Channel& channel);
+
         // Returns an interface to a JSON struct that can be used to return specific metadata information with respect
         // to this plugin. This Metadata can be used by the MetData plugin to publish this information to the ouside world.
         virtual string Information() const;
@@ -959,6 +1362,16 @@ namespace Plugin {
         // based on a a request is handled.
         virtual Core::ProxyType<Web::Response> Process(const Web::Request& request);
 
+        //  IChannel methods
+        // -------------------------------------------------------------------------------------------------------
+        // Whenever a WebSocket is opened with a locator (URL) pointing to this plugin, it is capable of receiving
+        // raw data for the plugin. Here it carries the filter for the traces streamed over this WebSocket.
+        virtual uint32_t Inbound(const uint32_t ID, const uint8_t data[], const uint16_t length);
+
+        // Whenever a WebSocket is opened with a locator (URL) pointing to this plugin, it is capable of sending
+        // raw data to the initiator of the websocket. Here it carries the traces matching the filter.
+        virtual uint32_t Outbound(const uint32_t ID, uint8_t data[], const uint16_t length) const;
+
     private:
         void Dispatch(Observer::Source& information);
 
@@ -967,6 +1380,11 @@ namespace Plugin {
         JsonData::TraceControl::StateType TranslateState(TraceControl::state state);
         uint32_t endpoint_status(const JsonData::TraceControl::StatusParamsData& params, JsonData::TraceControl::StatusResultData& response);
         uint32_t endpoint_set(const JsonData::TraceControl::TraceInfo& params);
+        uint32_t endpoint_throttle(const Data::Throttle& params);
+        uint32_t get_throttles(Core::JSON::ArrayType<Data::Throttle>& response) const;
+        uint32_t get_statistics(Core::JSON::ArrayType<Data::Source>& response) const;
+        void Throttle(const string& module, const string& category, const uint32_t rate, const uint32_t burst, const uint32_t sample);
+        void Throttled(const string& module, const string& category, uint32_t& rate, uint32_t& burst, uint32_t& sample) const;
         inline const string& TracePath() const 
         {
             return (_tracePath);
@@ -977,6 +1395,11 @@ namespace Plugin {
         PluginHost::IShell* _service;
         Config _config;
         std::list<Trace::ITraceMedia*> _outputs;
+        std::list<TraceOutput*> _localOutputs;
+        TraceRemote* _remote;
+        TraceRecorder* _recorder;
+        TraceThrottle _throttle;
+        TraceStream _streams;
         string _tracePath;
         Observer _observer;
     };
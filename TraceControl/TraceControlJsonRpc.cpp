@@ -16,10 +16,16 @@ namespace Plugin {
     {
         Register<StatusParamsData,StatusResultData>(_T("status"), &TraceControl::endpoint_status, this);
         Register<TraceInfo,void>(_T("set"), &TraceControl::endpoint_set, this);
+        Register<Data::Throttle,void>(_T("throttle"), &TraceControl::endpoint_throttle, this);
+        Property<Core::JSON::ArrayType<Data::Throttle>>(_T("throttles"), &TraceControl::get_throttles, nullptr, this);
+        Property<Core::JSON::ArrayType<Data::Source>>(_T("statistics"), &TraceControl::get_statistics, nullptr, this);
     }
 
     void TraceControl::UnregisterAll()
     {
+        Unregister(_T("statistics"));
+        Unregister(_T("throttles"));
+        Unregister(_T("throttle"));
         Unregister(_T("set"));
         Unregister(_T("status"));
     }
@@ -96,6 +102,47 @@ namespace Plugin {
 
         return result;
     }
+
+    // Method: throttle - Sets the rate limit and/or sampling of a module/category, a rate and sample of 0 removes it
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_BAD_REQUEST: Module or category missing
+    uint32_t TraceControl::endpoint_throttle(const Data::Throttle& params)
+    {
+        uint32_t result = Core::ERROR_NONE;
+
+        if ((params.Module.IsSet() == false) || (params.Category.IsSet() == false)) {
+            result = Core::ERROR_BAD_REQUEST;
+        } else {
+            Throttle(params.Module.Value(), params.Category.Value(), params.Rate.Value(), params.Burst.Value(), params.Sample.Value());
+        }
+
+        return result;
+    }
+
+    // Property: throttles - The active rate limits/samplings and the number of traces they suppressed
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t TraceControl::get_throttles(Core::JSON::ArrayType<Data::Throttle>& response) const
+    {
+        _throttle.Visit([&response](const TraceThrottle::Limit& limit) {
+            response.Add(Data::Throttle(limit));
+        });
+
+        return Core::ERROR_NONE;
+    }
+
+    // Property: statistics - Throughput, failures and dispatch lag of every trace source
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t TraceControl::get_statistics(Core::JSON::ArrayType<Data::Source>& response) const
+    {
+        _observer.Visit([&response](const Observer::Source& source) {
+            response.Add(Data::Source(source));
+        });
+
+        return Core::ERROR_NONE;
+    }
 } // namespace Plugin
 
 }
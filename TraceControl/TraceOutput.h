@@ -2,45 +2,266 @@
 
 #include "Module.h"
 
+#include <atomic>
+
 #ifndef __WIN32__
 #include <syslog.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #endif
 
 namespace WPEFramework {
 namespace Plugin {
 
     class TraceOutput : public Trace::ITraceMedia {
+    public:
+        // Number of lines that can be queued for the writer, must be a power of 2.
+        static constexpr uint32_t QueueSize = 256;
+        // Maximum length of a single formatted line, longer lines are truncated.
+        static constexpr uint32_t LineSize = 512;
+        // Maximum number of lines handed over to the console in a single writev.
+        static constexpr uint32_t BatchSize = 64;
+
     private:
+        TraceOutput() = delete;
         TraceOutput(const TraceOutput&) = delete;
         TraceOutput& operator=(const TraceOutput&) = delete;
 
+        static constexpr uint64_t MicroSecondsPerSecond = 1000 * 1000;
+
+        struct Line {
+            uint16_t Length;
+            char Text[LineSize];
+        };
+
+        class Writer : public Core::Thread {
+        private:
+            Writer() = delete;
+            Writer(const Writer&) = delete;
+            Writer& operator=(const Writer&) = delete;
+
+        public:
+            Writer(TraceOutput& parent)
+                : Core::Thread(Core::Thread::DefaultStackSize(), _T("TraceWriter"))
+                , _parent(parent)
+                , _signal(false, true)
+            {
+            }
+            ~Writer()
+            {
+                Stop();
+            }
+
+        public:
+            inline void Signal()
+            {
+                _signal.SetEvent();
+            }
+            void Stop()
+            {
+                Block();
+
+                _signal.SetEvent();
+
+                Wait(Thread::BLOCKED | Thread::STOPPED | Thread::STOPPING, Core::infinite);
+            }
+
+        private:
+            virtual uint32_t Worker()
+            {
+                while ((IsRunning() == true) && (_signal.Lock(Core::infinite) == Core::ERROR_NONE)) {
+                    // Reset before draining, anything queued from now on will retrigger us.
+                    _signal.ResetEvent();
+
+                    _parent.Drain();
+                }
+
+                return (Core::infinite);
+            }
+
+        private:
+            TraceOutput& _parent;
+            Core::Event _signal;
+        };
+
     public:
         TraceOutput(const bool syslogging)
             : _syslogging(syslogging)
+            , _head(0)
+            , _tail(0)
+            , _written(0)
+            , _dropped(0)
+            , _overflows(0)
+            , _full(false)
+            , _second(~0)
+            , _prefixLength(0)
+            , _writer(*this)
         {
+            _writer.Run();
         }
         virtual ~TraceOutput()
         {
+            _writer.Stop();
+
+            // Whatever made it into the queue, still deserves to be written.
+            Drain();
         }
 
     public:
+        inline uint32_t Written() const
+        {
+            return (_written.load());
+        }
+        inline uint32_t Dropped() const
+        {
+            return (_dropped.load());
+        }
+        inline uint32_t Overflows() const
+        {
+            return (_overflows.load());
+        }
+
         virtual void Output(const char fileName[], const uint32_t lineNumber, const char className[], const Trace::ITrace* information)
         {
-            // Time to printf...
-            string time(Core::Time::Now().ToRFC1123(true));
+            Output(Core::Time::Now().Ticks(), fileName, lineNumber, className, information);
+        }
+
+        // Only to be called from a single thread, the trace worker, as that is the sole producer on the queue.
+        void Output(const uint64_t timestamp, const char fileName[], const uint32_t lineNumber, const char /* className */[], const Trace::ITrace* information)
+        {
+            uint32_t head = _head.load(std::memory_order_relaxed);
 
+            if ((head - _tail.load(std::memory_order_acquire)) >= QueueSize) {
+                // The writer can not keep up, rather drop the line than stall merging all other sources.
+                _dropped++;
+
+                if (_full == false) {
+                    _full = true;
+                    _overflows++;
+                }
+            } else {
+                Line& line(_lines[head & (QueueSize - 1)]);
+
+                _full = false;
+
+                if ((timestamp / MicroSecondsPerSecond) != _second) {
+                    // The prefix only changes once a second, so there is no need to format it for every line.
+                    string time(Core::Time(timestamp).ToRFC1123(true));
+
+                    _second = timestamp / MicroSecondsPerSecond;
+                    _prefixLength = static_cast<uint16_t>(std::min(time.length(), sizeof(_prefix) - 1));
+                    ::memcpy(_prefix, time.c_str(), _prefixLength);
+                    _prefix[_prefixLength] = '\0';
+                }
+
+                int length = snprintf(line.Text, sizeof(line.Text), "[%s]:[%s:%d] %s: %s\n", _prefix, Core::FileNameOnly(fileName), lineNumber, information->Category(), information->Data());
+
+                if (length < 0) {
+                    length = 0;
+                } else if (static_cast<uint32_t>(length) >= sizeof(line.Text)) {
+                    // Truncated, make sure the line is still terminated by a newline.
+                    length = sizeof(line.Text) - 1;
+                    line.Text[length - 1] = '\n';
+                }
+
+                line.Length = static_cast<uint16_t>(length);
+
+                _head.store(head + 1, std::memory_order_release);
+
+                _writer.Signal();
+            }
+        }
+
+    private:
+        void Drain()
+        {
+            uint32_t tail = _tail.load(std::memory_order_relaxed);
+            uint32_t head = _head.load(std::memory_order_acquire);
+
+            while (tail != head) {
+                uint32_t count = ((head - tail) < BatchSize ? (head - tail) : BatchSize);
+
+                Write(tail, count);
+
+                tail += count;
+                _written += count;
+
+                // Release the slots to the producer, before looking if more came in.
+                _tail.store(tail, std::memory_order_release);
+
+                head = _head.load(std::memory_order_acquire);
+            }
+        }
+        void Write(const uint32_t first, const uint32_t count)
+        {
 #ifndef __WIN32__
             if (_syslogging == true) {
-                syslog(LOG_NOTICE, "[%s]:[%s:%d] %s: %s\n", time.c_str(), Core::FileNameOnly(fileName), lineNumber, information->Category(), information->Data());
-            } else
-#endif
-            {
-                printf("[%s]:[%s:%d] %s: %s\n", time.c_str(), Core::FileNameOnly(fileName), lineNumber, information->Category(), information->Data());
+                for (uint32_t index = 0; index < count; index++) {
+                    const Line& line(_lines[(first + index) & (QueueSize - 1)]);
+
+                    syslog(LOG_NOTICE, "%.*s", line.Length, line.Text);
+                }
+            } else {
+                struct iovec vector[BatchSize];
+                uint32_t entries = 0;
+
+                for (uint32_t index = 0; index < count; index++) {
+                    const Line& line(_lines[(first + index) & (QueueSize - 1)]);
+
+                    vector[entries].iov_base = const_cast<char*>(line.Text);
+                    vector[entries].iov_len = line.Length;
+                    entries++;
+                }
+
+                struct iovec* current = vector;
+
+                while (entries > 0) {
+                    ssize_t result = ::writev(STDOUT_FILENO, current, entries);
+
+                    if (result < 0) {
+                        if (errno != EINTR) {
+                            // Nothing more we can do, the console is gone..
+                            break;
+                        }
+                    } else {
+                        size_t written = static_cast<size_t>(result);
+
+                        // Skip what has been written, continue with the rest on a partial write.
+                        while ((entries > 0) && (written >= current->iov_len)) {
+                            written -= current->iov_len;
+                            current++;
+                            entries--;
+                        }
+                        if (entries > 0) {
+                            current->iov_base = static_cast<char*>(current->iov_base) + written;
+                            current->iov_len -= written;
+                        }
+                    }
+                }
+            }
+#else
+            for (uint32_t index = 0; index < count; index++) {
+                const Line& line(_lines[(first + index) & (QueueSize - 1)]);
+
+                fwrite(line.Text, 1, line.Length, stdout);
             }
+            fflush(stdout);
+#endif
         }
 
     private:
         bool _syslogging;
+        std::atomic<uint32_t> _head;
+        std::atomic<uint32_t> _tail;
+        std::atomic<uint32_t> _written;
+        std::atomic<uint32_t> _dropped;
+        std::atomic<uint32_t> _overflows;
+        bool _full;
+        uint64_t _second;
+        uint16_t _prefixLength;
+        char _prefix[64];
+        Line _lines[QueueSize];
+        Writer _writer;
     };
 }
 }
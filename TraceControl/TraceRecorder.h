@@ -0,0 +1,332 @@
+#pragma once
+
+#include "Module.h"
+
+#include <atomic>
+#include <unordered_map>
+
+#ifndef __WIN32__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Records the traces, in binary form, in a ring of memory mapped files of a fixed size. Once the last
+    // file is full, recording continues in the first one. Nothing is formatted at runtime, the Tools/TraceDecoder
+    // turns the files back into text or JSON.
+    //
+    // File layout (little endian):
+    //   header: magic (4 bytes, "TRCB") - version (2 bytes) - reserved (2 bytes) - sequence (4 bytes) - used (4 bytes)
+    //   followed by records, each starting with a type byte:
+    //   STRING: id (2 bytes) - length (2 bytes) - characters (not terminated)
+    //   ENTRY:  clock ticks (8 bytes) - line number (4 bytes) - file/module/category/className id (4 x 2 bytes) - length (2 bytes) - information
+    // The strings are interned per file, a STRING record always preceeds the first ENTRY referring to it, so
+    // every file can be decoded on its own. "used" holds the number of valid bytes, including the header.
+    // The sequence numbers continue where the files of a previous run left off, so sorting on them always
+    // puts the files in the order they were written.
+    class TraceRecorder : public Trace::ITraceMedia {
+    public:
+        static constexpr uint32_t Magic = 0x42435254;
+        static constexpr uint16_t Version = 1;
+        static constexpr uint16_t HeaderSize = 4 + 2 + 2 + 4 + 4;
+
+        enum record : uint8_t {
+            STRING = 1,
+            ENTRY = 2
+        };
+
+    private:
+        TraceRecorder() = delete;
+        TraceRecorder(const TraceRecorder&) = delete;
+        TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+        static constexpr uint16_t EntrySize = 1 + 8 + 4 + (4 * 2) + 2;
+        static constexpr uint16_t StringSize = 1 + 2 + 2;
+
+    public:
+        TraceRecorder(const string& path, const uint32_t fileSize, const uint8_t files)
+            : _path(Core::Directory::Normalize(path))
+            , _fileSize(fileSize > (HeaderSize + EntrySize + (4 * StringSize) + 1024) ? fileSize : (HeaderSize + EntrySize + (4 * StringSize) + 1024))
+            , _files(files > 0 ? files : 1)
+            , _index(0)
+            , _sequence(0)
+            , _descriptor(-1)
+            , _data(nullptr)
+            , _used(0)
+            , _strings()
+            , _lookup()
+            , _recorded(0)
+            , _dropped(0)
+        {
+            Core::Directory(_path.c_str()).CreatePath();
+
+            Resume();
+            Open();
+        }
+        virtual ~TraceRecorder()
+        {
+            Close();
+        }
+
+    public:
+        inline uint32_t Recorded() const
+        {
+            return (_recorded.load());
+        }
+        inline uint32_t Dropped() const
+        {
+            return (_dropped.load());
+        }
+
+        virtual void Output(const char fileName[], const uint32_t lineNumber, const char className[], const Trace::ITrace* information)
+        {
+            Output(Core::Time::Now().Ticks(), fileName, lineNumber, className, information);
+        }
+
+        // Only to be called from the trace worker thread.
+        void Output(const uint64_t timestamp, const char fileName[], const uint32_t lineNumber, const char className[], const Trace::ITrace* information)
+        {
+            const char* const strings[] = { fileName, information->Module(), information->Category(), className };
+            uint16_t length = information->Length();
+            uint16_t ids[4];
+            bool stored = false;
+
+            // If it does not fit in the current file, it should fit in a fresh one, give it at most one retry.
+            for (uint8_t attempt = 0; (attempt < 2) && (stored == false) && (_data != nullptr); attempt++) {
+                uint32_t mark = _used;
+                uint8_t index = 0;
+
+                while ((index < 4) && (Intern(strings[index], ids[index]) == true)) {
+                    index++;
+                }
+
+                if ((index == 4) && ((_used + EntrySize + length) <= _fileSize)) {
+                    uint8_t* record = &(_data[_used]);
+
+                    record[0] = ENTRY;
+                    Store<uint64_t>(&(record[1]), timestamp);
+                    Store<uint32_t>(&(record[9]), lineNumber);
+                    Store<uint16_t>(&(record[13]), ids[0]);
+                    Store<uint16_t>(&(record[15]), ids[1]);
+                    Store<uint16_t>(&(record[17]), ids[2]);
+                    Store<uint16_t>(&(record[19]), ids[3]);
+                    Store<uint16_t>(&(record[21]), length);
+                    ::memcpy(&(record[EntrySize]), information->Data(), length);
+
+                    _used += EntrySize + length;
+                    Store<uint32_t>(&(_data[12]), _used);
+
+                    stored = true;
+                    _recorded++;
+                } else if (mark == HeaderSize) {
+                    // Does not even fit in an empty file, no use in rotating.
+                    break;
+                } else {
+                    Rotate();
+                }
+            }
+
+            if (stored == false) {
+                _dropped++;
+            }
+        }
+
+    private:
+        template <typename TYPE>
+        static void Store(uint8_t* buffer, const TYPE value)
+        {
+            for (uint8_t index = 0; index < sizeof(TYPE); index++) {
+                buffer[index] = static_cast<uint8_t>(value >> (8 * index));
+            }
+        }
+        template <typename TYPE>
+        static TYPE Load(const uint8_t* buffer)
+        {
+            TYPE result = 0;
+
+            for (uint8_t index = 0; index < sizeof(TYPE); index++) {
+                result |= static_cast<TYPE>(buffer[index]) << (8 * index);
+            }
+
+            return (result);
+        }
+        static uint32_t Hash(const char text[], uint16_t& length)
+        {
+            // FNV-1a, good enough to tell the few hundred strings we intern apart.
+            uint32_t hash = 2166136261u;
+            const char* current = text;
+
+            while (*current != '\0') {
+                hash = (hash ^ static_cast<uint8_t>(*current)) * 16777619u;
+                current++;
+            }
+
+            length = static_cast<uint16_t>(current - text);
+
+            return (hash);
+        }
+        bool Intern(const char text[], uint16_t& id)
+        {
+            uint16_t length;
+            uint32_t hash = Hash(text, length);
+            bool result = false;
+
+            std::pair<std::unordered_multimap<uint32_t, uint16_t>::const_iterator, std::unordered_multimap<uint32_t, uint16_t>::const_iterator> range(_lookup.equal_range(hash));
+
+            while ((range.first != range.second) && (result == false)) {
+                if (_strings[range.first->second] == text) {
+                    id = range.first->second;
+                    result = true;
+                }
+                range.first++;
+            }
+
+            if ((result == false) && (_strings.size() < 0xFFFF) && ((_used + StringSize + length) <= _fileSize)) {
+                uint8_t* record = &(_data[_used]);
+
+                id = static_cast<uint16_t>(_strings.size());
+
+                record[0] = STRING;
+                Store<uint16_t>(&(record[1]), id);
+                Store<uint16_t>(&(record[3]), length);
+                ::memcpy(&(record[StringSize]), text, length);
+
+                _used += StringSize + length;
+                Store<uint32_t>(&(_data[12]), _used);
+
+                _strings.push_back(string(text, length));
+                _lookup.insert(std::pair<const uint32_t, uint16_t>(hash, id));
+
+                result = true;
+            }
+
+            return (result);
+        }
+        inline string FileName(const uint8_t index) const
+        {
+            return (_path + _T("trace.") + Core::NumberType<uint8_t>(index).Text() + _T(".bin"));
+        }
+        // Picks up after the newest file in the ring, the next one to write is the oldest. Files beyond the
+        // ring, left by a run with more files, would never be overwritten and are removed.
+        void Resume()
+        {
+#ifndef __WIN32__
+            bool found = false;
+            uint16_t index = 0;
+
+            while (index <= 0xFF) {
+                const string fileName(FileName(static_cast<uint8_t>(index)));
+
+                if (index >= _files) {
+                    ::unlink(fileName.c_str());
+                } else {
+                    int fd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+
+                    if (fd != -1) {
+                        uint8_t header[HeaderSize];
+
+                        if ((::read(fd, header, sizeof(header)) == static_cast<ssize_t>(sizeof(header))) && (Load<uint32_t>(header) == Magic)) {
+                            const uint32_t sequence = Load<uint32_t>(&(header[8]));
+
+                            if ((found == false) || (sequence >= _sequence)) {
+                                _sequence = sequence;
+                                _index = static_cast<uint8_t>(index);
+                                found = true;
+                            }
+                        }
+
+                        ::close(fd);
+                    }
+                }
+
+                index++;
+            }
+
+            if (found == true) {
+                _sequence++;
+                _index = static_cast<uint8_t>((_index + 1) % _files);
+            }
+#endif
+        }
+        void Open()
+        {
+            string fileName(FileName(_index));
+
+#ifndef __WIN32__
+            _descriptor = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+            if (_descriptor != -1) {
+                if (::ftruncate(_descriptor, _fileSize) == 0) {
+                    void* data = ::mmap(nullptr, _fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, _descriptor, 0);
+
+                    if (data != MAP_FAILED) {
+                        _data = static_cast<uint8_t*>(data);
+                    }
+                }
+
+                if (_data == nullptr) {
+                    TRACE_L1("Could not map the trace recording %s, error: %d", fileName.c_str(), errno);
+                    ::close(_descriptor);
+                    _descriptor = -1;
+                }
+            }
+#endif
+            if (_data != nullptr) {
+                _used = HeaderSize;
+
+                Store<uint32_t>(&(_data[0]), Magic);
+                Store<uint16_t>(&(_data[4]), Version);
+                Store<uint16_t>(&(_data[6]), 0);
+                Store<uint32_t>(&(_data[8]), _sequence++);
+                Store<uint32_t>(&(_data[12]), _used);
+            }
+        }
+        void Close()
+        {
+#ifndef __WIN32__
+            if (_data != nullptr) {
+                ::msync(_data, _used, MS_ASYNC);
+                ::munmap(_data, _fileSize);
+                _data = nullptr;
+
+                // Do not leave the unused tail of the file around.
+                if (::ftruncate(_descriptor, _used) != 0) {
+                    TRACE_L1("Could not trim the trace recording, error: %d", errno);
+                }
+            }
+            if (_descriptor != -1) {
+                ::close(_descriptor);
+                _descriptor = -1;
+            }
+#endif
+            _strings.clear();
+            _lookup.clear();
+        }
+        void Rotate()
+        {
+            Close();
+
+            _index = static_cast<uint8_t>((_index + 1) % _files);
+
+            Open();
+        }
+
+    private:
+        const string _path;
+        const uint32_t _fileSize;
+        const uint8_t _files;
+        uint8_t _index;
+        uint32_t _sequence;
+        int _descriptor;
+        uint8_t* _data;
+        uint32_t _used;
+        std::vector<string> _strings;
+        std::unordered_multimap<uint32_t, uint16_t> _lookup;
+        std::atomic<uint32_t> _recorded;
+        std::atomic<uint32_t> _dropped;
+    };
+}
+}
@@ -0,0 +1,355 @@
+#pragma once
+
+#include "Module.h"
+
+#include <atomic>
+
+#ifndef __WIN32__
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Sends the traces to a remote collector, packing as many entries as fit in a single datagram.
+    //
+    // Datagram layout (little endian):
+    //   magic (2 bytes, "TR") - entries (2 bytes) - sequence (4 bytes) - dropped (4 bytes)
+    //   followed by "entries" times the entry layout as it is found in the trace cyclic buffer:
+    //   length (2 bytes) - clock ticks (8 bytes) - line number (4 bytes) - file/module/category/className - information
+    // Each datagram carries the next sequence number, so a collector can detect lost datagrams. Entries that
+    // never made it into a datagram have no sequence number, "dropped" counts them since the start.
+    class TraceRemote : public Trace::ITraceMedia {
+    public:
+        static constexpr uint16_t Magic = 0x5254;
+        static constexpr uint16_t HeaderSize = 2 + 2 + 4 + 4;
+        // Maximum number of datagrams handed over to the kernel in one go.
+        static constexpr uint32_t BatchSize = 16;
+
+    private:
+        TraceRemote() = delete;
+        TraceRemote(const TraceRemote&) = delete;
+        TraceRemote& operator=(const TraceRemote&) = delete;
+
+        // Datagrams that can be pending, the producer can fill one batch while the other is being sent.
+        static constexpr uint32_t Slots = 2 * BatchSize;
+
+        class Sender : public Core::Thread {
+        private:
+            Sender() = delete;
+            Sender(const Sender&) = delete;
+            Sender& operator=(const Sender&) = delete;
+
+        public:
+            Sender(TraceRemote& parent)
+                : Core::Thread(Core::Thread::DefaultStackSize(), _T("TraceSender"))
+                , _parent(parent)
+                , _signal(false, true)
+            {
+            }
+            ~Sender()
+            {
+                Stop();
+            }
+
+        public:
+            inline void Signal()
+            {
+                _signal.SetEvent();
+            }
+            void Stop()
+            {
+                Block();
+
+                _signal.SetEvent();
+
+                Wait(Thread::BLOCKED | Thread::STOPPED | Thread::STOPPING, Core::infinite);
+            }
+
+        private:
+            virtual uint32_t Worker()
+            {
+                while (IsRunning() == true) {
+                    // If there is nothing pending, there is no need to wake up on the latency timer.
+                    _signal.Lock(_parent.Pending() == true ? _parent.Latency() : Core::infinite);
+                    _signal.ResetEvent();
+
+                    if (IsRunning() == true) {
+                        _parent.Send(false);
+                    }
+                }
+
+                return (Core::infinite);
+            }
+
+        private:
+            TraceRemote& _parent;
+            Core::Event _signal;
+        };
+
+    public:
+        TraceRemote(const Core::NodeId& node, const uint16_t mtu, const uint16_t latency)
+            : _adminLock()
+            , _node(node)
+            , _socket(-1)
+            , _mtu(mtu > HeaderSize + 64 ? mtu : HeaderSize + 64)
+            , _latency(latency)
+            , _storage(new uint8_t[Slots * _mtu])
+            , _head(0)
+            , _tail(0)
+            , _fill(HeaderSize)
+            , _entries(0)
+            , _opened(0)
+            , _sequence(0)
+            , _sent(0)
+            , _dropped(0)
+            , _lost(0)
+            , _sender(*this)
+        {
+#ifndef __WIN32__
+            _socket = ::socket(static_cast<const struct sockaddr*>(_node)->sa_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+#endif
+            if (_socket == -1) {
+                TRACE_L1("Could not open the remote trace socket, error: %d", errno);
+            }
+
+            _sender.Run();
+        }
+        virtual ~TraceRemote()
+        {
+            _sender.Stop();
+
+            // Send out what is still pending..
+            Send(true);
+
+#ifndef __WIN32__
+            if (_socket != -1) {
+                ::close(_socket);
+            }
+#endif
+            delete[] _storage;
+        }
+
+    public:
+        // Datagrams handed over to the network.
+        inline uint32_t Sent() const
+        {
+            return (_sent.load());
+        }
+        // Entries that did not fit in a datagram or found all datagrams waiting to be sent.
+        inline uint32_t Dropped() const
+        {
+            return (_dropped.load());
+        }
+        // Datagrams that could not be sent.
+        inline uint32_t Lost() const
+        {
+            return (_lost.load());
+        }
+
+        virtual void Output(const char fileName[], const uint32_t lineNumber, const char className[], const Trace::ITrace* information)
+        {
+            Output(Core::Time::Now().Ticks(), fileName, lineNumber, className, information);
+        }
+
+        void Output(const uint64_t timestamp, const char fileName[], const uint32_t lineNumber, const char className[], const Trace::ITrace* information)
+        {
+            const char* const strings[] = { fileName, information->Module(), information->Category(), className };
+            uint16_t lengths[(sizeof(strings) / sizeof(const char*))];
+            uint32_t size = 2 + 8 + 4;
+
+            for (uint8_t index = 0; index < (sizeof(strings) / sizeof(const char*)); index++) {
+                lengths[index] = static_cast<uint16_t>(strlen(strings[index]) + 1);
+                size += lengths[index];
+            }
+
+            if ((size + HeaderSize) >= _mtu) {
+                // Even without the information this does not fit, nothing sensible to send.
+                _dropped++;
+            } else {
+                // Information is truncated to what fits in a single datagram.
+                uint16_t length = information->Length();
+
+                if ((size + length + HeaderSize) > _mtu) {
+                    length = static_cast<uint16_t>(_mtu - HeaderSize - size);
+                }
+
+                size += length;
+
+                _adminLock.Lock();
+
+                if ((_fill + size) > _mtu) {
+                    Close();
+                }
+
+                if ((_head - _tail) >= Slots) {
+                    // All datagrams are waiting to be sent, the network can not keep up..
+                    _dropped++;
+
+                    _adminLock.Unlock();
+                } else {
+                    uint8_t* entry = Datagram(_head) + _fill;
+                    bool first = ((_entries == 0) && (_head == _tail));
+
+                    if (_entries == 0) {
+                        _opened = Core::Time::Now().Ticks();
+                    }
+
+                    Store<uint16_t>(entry, static_cast<uint16_t>(size));
+                    Store<uint64_t>(entry + 2, timestamp);
+                    Store<uint32_t>(entry + 10, lineNumber);
+                    entry += 14;
+
+                    for (uint8_t index = 0; index < (sizeof(strings) / sizeof(const char*)); index++) {
+                        ::memcpy(entry, strings[index], lengths[index]);
+                        entry += lengths[index];
+                    }
+
+                    ::memcpy(entry, information->Data(), length);
+
+                    _fill += static_cast<uint16_t>(size);
+                    _entries++;
+
+                    bool batched = ((_head - _tail) >= BatchSize);
+
+                    _adminLock.Unlock();
+
+                    if ((first == true) || (batched == true)) {
+                        // Either the latency timer needs to start, or there is a full batch to be sent.
+                        _sender.Signal();
+                    }
+                }
+            }
+        }
+
+    private:
+        template <typename TYPE>
+        static void Store(uint8_t* buffer, const TYPE value)
+        {
+            for (uint8_t index = 0; index < sizeof(TYPE); index++) {
+                buffer[index] = static_cast<uint8_t>(value >> (8 * index));
+            }
+        }
+        inline uint8_t* Datagram(const uint32_t index)
+        {
+            return (&(_storage[(index % Slots) * _mtu]));
+        }
+        inline uint32_t Latency() const
+        {
+            return (_latency);
+        }
+        bool Pending() const
+        {
+            _adminLock.Lock();
+            bool result = ((_head != _tail) || (_entries != 0));
+            _adminLock.Unlock();
+
+            return (result);
+        }
+        // Should be called with the _adminLock taken.
+        void Close()
+        {
+            if (_entries != 0) {
+                uint8_t* datagram = Datagram(_head);
+
+                Store<uint16_t>(datagram, Magic);
+                Store<uint16_t>(datagram + 2, _entries);
+                Store<uint32_t>(datagram + 4, _sequence++);
+                Store<uint32_t>(datagram + 8, _dropped.load());
+
+                _lengths[_head % Slots] = _fill;
+                _head++;
+                _fill = HeaderSize;
+                _entries = 0;
+            }
+        }
+        void Send(const bool flush)
+        {
+            _adminLock.Lock();
+
+            // Whatever is in the open datagram has waited long enough, close it so it goes out with this batch.
+            if ((_entries != 0) && ((flush == true) || ((Core::Time::Now().Ticks() - _opened) >= (static_cast<uint64_t>(_latency) * 1000)))) {
+                Close();
+            }
+
+            uint32_t tail = _tail;
+            uint32_t head = _head;
+
+            _adminLock.Unlock();
+
+            // The closed datagrams in between tail and head are owned by us, the producer does not touch them.
+            while (tail != head) {
+                uint32_t count = ((head - tail) < BatchSize ? (head - tail) : BatchSize);
+
+                Transmit(tail, count);
+
+                tail += count;
+
+                _adminLock.Lock();
+                _tail = tail;
+                head = _head;
+                _adminLock.Unlock();
+            }
+        }
+        void Transmit(const uint32_t first, const uint32_t count)
+        {
+#ifndef __WIN32__
+            if (_socket != -1) {
+                struct mmsghdr messages[BatchSize];
+                struct iovec vectors[BatchSize];
+
+                ::memset(messages, 0, sizeof(messages));
+
+                for (uint32_t index = 0; index < count; index++) {
+                    vectors[index].iov_base = Datagram(first + index);
+                    vectors[index].iov_len = _lengths[(first + index) % Slots];
+                    messages[index].msg_hdr.msg_name = const_cast<struct sockaddr*>(static_cast<const struct sockaddr*>(_node));
+                    messages[index].msg_hdr.msg_namelen = _node.Size();
+                    messages[index].msg_hdr.msg_iov = &(vectors[index]);
+                    messages[index].msg_hdr.msg_iovlen = 1;
+                }
+
+                uint32_t offset = 0;
+
+                while (offset < count) {
+                    int result = ::sendmmsg(_socket, &(messages[offset]), count - offset, 0);
+
+                    if (result > 0) {
+                        offset += result;
+                        _sent += result;
+                    } else if (errno != EINTR) {
+                        // The datagrams are lost, the sequence numbers tell the collector.
+                        _lost += (count - offset);
+                        break;
+                    }
+                }
+            } else {
+                _lost += count;
+            }
+#else
+            _lost += count;
+#endif
+        }
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        Core::NodeId _node;
+        int _socket;
+        uint16_t _mtu;
+        uint16_t _latency;
+        uint8_t* _storage;
+        uint16_t _lengths[Slots];
+        uint32_t _head;
+        uint32_t _tail;
+        uint16_t _fill;
+        uint16_t _entries;
+        uint64_t _opened;
+        uint32_t _sequence;
+        std::atomic<uint32_t> _sent;
+        std::atomic<uint32_t> _dropped;
+        std::atomic<uint32_t> _lost;
+        Sender _sender;
+    };
+}
+}
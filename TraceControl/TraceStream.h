@@ -0,0 +1,342 @@
+#pragma once
+
+#include "Module.h"
+
+#include <atomic>
+#include <regex>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Streams the traces live over the WebSocket channels opened on the plugin. Every channel carries its own
+    // filter, evaluated on the trace worker, so only the entries someone asked for are serialized and sent.
+    // The filter is taken from the query of the channel (module=<name>&category=<name>) and can be replaced
+    // at any time by sending a JSON object over the channel: {"module":"...", "category":"...", "regex":"..."}.
+    // Absent or empty fields match everything, the regex is searched for in the trace message.
+    class TraceStream {
+    private:
+        TraceStream(const TraceStream&) = delete;
+        TraceStream& operator=(const TraceStream&) = delete;
+
+    public:
+        class Filter : public Core::JSON::Container {
+        private:
+            Filter(const Filter&) = delete;
+            Filter& operator=(const Filter&) = delete;
+
+        public:
+            Filter()
+                : Core::JSON::Container()
+            {
+                Add(_T("module"), &Module);
+                Add(_T("category"), &Category);
+                Add(_T("regex"), &Regex);
+            }
+            ~Filter()
+            {
+            }
+
+        public:
+            Core::JSON::String Module;
+            Core::JSON::String Category;
+            Core::JSON::String Regex;
+        };
+
+        class Entry : public Core::JSON::Container {
+        private:
+            Entry(const Entry&) = delete;
+            Entry& operator=(const Entry&) = delete;
+
+        public:
+            Entry()
+                : Core::JSON::Container()
+            {
+                Add(_T("time"), &Time);
+                Add(_T("file"), &File);
+                Add(_T("line"), &Line);
+                Add(_T("module"), &Module);
+                Add(_T("category"), &Category);
+                Add(_T("message"), &Message);
+            }
+            ~Entry()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt64 Time;
+            Core::JSON::String File;
+            Core::JSON::DecUInt32 Line;
+            Core::JSON::String Module;
+            Core::JSON::String Category;
+            Core::JSON::String Message;
+        };
+
+    private:
+        class Subscriber {
+        private:
+            Subscriber() = delete;
+            Subscriber(const Subscriber&) = delete;
+            Subscriber& operator=(const Subscriber&) = delete;
+
+        public:
+            Subscriber(PluginHost::Channel& channel, const uint32_t maxPending)
+                : _channel(channel)
+                , _module()
+                , _category()
+                , _regex()
+                , _hasRegex(false)
+                , _pending()
+                , _pendingSize(0)
+                , _maxPending(maxPending)
+                , _dropped(0)
+            {
+                Query(channel.Query());
+            }
+            ~Subscriber()
+            {
+            }
+
+        public:
+            bool Update(const Filter& filter)
+            {
+                bool result = true;
+
+                _module = filter.Module.Value();
+                _category = filter.Category.Value();
+                _hasRegex = (filter.Regex.Value().empty() == false);
+
+                if (_hasRegex == true) {
+                    try {
+                        _regex = std::regex(filter.Regex.Value(), std::regex::ECMAScript | std::regex::nosubs);
+                    } catch (const std::regex_error&) {
+                        // An invalid expression would match nothing, rather report it and stream everything else.
+                        TRACE_L1("Invalid trace filter expression: %s", filter.Regex.Value().c_str());
+                        _hasRegex = false;
+                        result = false;
+                    }
+                }
+
+                return (result);
+            }
+            bool Matches(const char module[], const char category[], const char message[]) const
+            {
+                return (((_module.empty() == true) || (_module == module)) && ((_category.empty() == true) || (_category == category)) && ((_hasRegex == false) || (std::regex_search(message, _regex) == true)));
+            }
+            void Push(const string& text)
+            {
+                if ((_pendingSize + text.length() + 1) > _maxPending) {
+                    // This subscriber does not keep up, do not let it eat all our memory.
+                    _dropped++;
+                } else {
+                    bool wasEmpty = _pending.empty();
+
+                    _pending.push_back(text);
+                    _pendingSize += static_cast<uint32_t>(text.length() + 1);
+
+                    if (wasEmpty == true) {
+                        _channel.RequestOutbound();
+                    }
+                }
+            }
+            // Fill the frame with as many complete entries as fit, one per line.
+            uint16_t Pop(uint8_t data[], const uint16_t length)
+            {
+                uint16_t result = 0;
+
+                while ((_pending.empty() == false) && ((result + _pending.front().length() + 1) <= length)) {
+                    const string& text(_pending.front());
+
+                    ::memcpy(&(data[result]), text.c_str(), text.length());
+                    result += static_cast<uint16_t>(text.length());
+                    data[result++] = '\n';
+
+                    _pendingSize -= static_cast<uint32_t>(text.length() + 1);
+                    _pending.pop_front();
+                }
+
+                if ((result == 0) && (_pending.empty() == false)) {
+                    // Does not fit in a single frame, it is of no use to anyone if we keep it.
+                    _pendingSize -= static_cast<uint32_t>(_pending.front().length() + 1);
+                    _pending.pop_front();
+                    _dropped++;
+                }
+
+                if (_pending.empty() == false) {
+                    _channel.RequestOutbound();
+                }
+
+                return (result);
+            }
+            inline uint32_t Dropped() const
+            {
+                return (_dropped);
+            }
+
+        private:
+            void Query(const string& query)
+            {
+                Core::TextSegmentIterator index(Core::TextFragment(query), false, '&');
+
+                while (index.Next() == true) {
+                    Core::TextFragment pair(index.Current());
+                    uint32_t marker = pair.ForwardFind('=');
+
+                    if (marker < pair.Length()) {
+                        string key(pair.Text().substr(0, marker));
+                        string value(pair.Text().substr(marker + 1));
+
+                        if (key == _T("module")) {
+                            _module = value;
+                        } else if (key == _T("category")) {
+                            _category = value;
+                        }
+                    }
+                }
+            }
+
+        private:
+            PluginHost::Channel& _channel;
+            string _module;
+            string _category;
+            std::regex _regex;
+            bool _hasRegex;
+            std::list<string> _pending;
+            uint32_t _pendingSize;
+            const uint32_t _maxPending;
+            uint32_t _dropped;
+        };
+
+    public:
+        TraceStream()
+            : _adminLock()
+            , _subscribers()
+            , _maxSubscribers(0)
+            , _maxPending(0)
+            , _active(0)
+        {
+        }
+        ~TraceStream()
+        {
+            std::map<const uint32_t, Subscriber*>::iterator index(_subscribers.begin());
+
+            while (index != _subscribers.end()) {
+                delete index->second;
+                index++;
+            }
+        }
+
+    public:
+        void Configure(const uint8_t maxSubscribers, const uint32_t maxPending)
+        {
+            _maxSubscribers = maxSubscribers;
+            _maxPending = maxPending;
+        }
+        bool Attach(PluginHost::Channel& channel)
+        {
+            bool result = false;
+
+            _adminLock.Lock();
+
+            if ((_subscribers.size() < _maxSubscribers) && (_subscribers.find(channel.Id()) == _subscribers.end())) {
+                _subscribers.insert(std::pair<const uint32_t, Subscriber*>(channel.Id(), new Subscriber(channel, _maxPending)));
+                _active = static_cast<uint32_t>(_subscribers.size());
+                result = true;
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+        void Detach(PluginHost::Channel& channel)
+        {
+            _adminLock.Lock();
+
+            std::map<const uint32_t, Subscriber*>::iterator index(_subscribers.find(channel.Id()));
+
+            if (index != _subscribers.end()) {
+                delete index->second;
+                _subscribers.erase(index);
+                _active = static_cast<uint32_t>(_subscribers.size());
+            }
+
+            _adminLock.Unlock();
+        }
+        uint32_t Inbound(const uint32_t ID, const uint8_t data[], const uint16_t length)
+        {
+            Filter filter;
+            string text(reinterpret_cast<const char*>(data), length);
+
+            filter.FromString(text);
+
+            _adminLock.Lock();
+
+            std::map<const uint32_t, Subscriber*>::iterator index(_subscribers.find(ID));
+
+            if (index != _subscribers.end()) {
+                index->second->Update(filter);
+            }
+
+            _adminLock.Unlock();
+
+            return (length);
+        }
+        uint32_t Outbound(const uint32_t ID, uint8_t data[], const uint16_t length) const
+        {
+            uint32_t result = 0;
+
+            _adminLock.Lock();
+
+            std::map<const uint32_t, Subscriber*>::const_iterator index(_subscribers.find(ID));
+
+            if (index != _subscribers.end()) {
+                result = index->second->Pop(data, length);
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+        // Called from the trace worker for every entry, without subscribers this should cost next to nothing.
+        void Output(const uint64_t timestamp, const char fileName[], const uint32_t lineNumber, const Trace::ITrace* information)
+        {
+            if (_active.load(std::memory_order_relaxed) != 0) {
+                string text;
+
+                _adminLock.Lock();
+
+                std::map<const uint32_t, Subscriber*>::iterator index(_subscribers.begin());
+
+                while (index != _subscribers.end()) {
+                    if (index->second->Matches(information->Module(), information->Category(), information->Data()) == true) {
+                        // Serialize only once, and only if at least one subscriber is interested.
+                        if (text.empty() == true) {
+                            Entry entry;
+
+                            entry.Time = timestamp;
+                            entry.File = Core::FileNameOnly(fileName);
+                            entry.Line = lineNumber;
+                            entry.Module = information->Module();
+                            entry.Category = information->Category();
+                            entry.Message = string(information->Data(), information->Length());
+                            entry.ToString(text);
+                        }
+
+                        index->second->Push(text);
+                    }
+                    index++;
+                }
+
+                _adminLock.Unlock();
+            }
+        }
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        std::map<const uint32_t, Subscriber*> _subscribers;
+        uint8_t _maxSubscribers;
+        uint32_t _maxPending;
+        std::atomic<uint32_t> _active;
+    };
+}
+}
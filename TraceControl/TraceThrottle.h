@@ -0,0 +1,267 @@
+#pragma once
+
+#include "Module.h"
+
+#include <atomic>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Limits the number of traces per module/category, before anything is handed over to the outputs.
+    // A limit can sample (only let 1 in N through) and/or rate limit (token bucket of "burst" traces,
+    // refilled with "rate" traces per second). An empty category applies to all categories of the module
+    // that do not have a limit of their own, what it suppresses is also counted per category.
+    class TraceThrottle {
+    private:
+        TraceThrottle(const TraceThrottle&) = delete;
+        TraceThrottle& operator=(const TraceThrottle&) = delete;
+
+        // Tokens are kept in millionths, so the refill per microsecond is just the rate.
+        static constexpr uint64_t Token = 1000 * 1000;
+
+    public:
+        class Limit {
+        public:
+            Limit() = delete;
+            Limit& operator=(const Limit&) = delete;
+
+            Limit(const string& module, const string& category, const uint32_t rate, const uint32_t burst, const uint32_t sample)
+                : _module(module)
+                , _category(category)
+                , _rate(rate)
+                , _burst(burst > 0 ? burst : (rate > 0 ? rate : 1))
+                , _sample(sample)
+                , _tokens(static_cast<uint64_t>(_burst) * Token)
+                , _refilled(0)
+                , _counter(0)
+                , _suppressed(0)
+                , _categories()
+            {
+            }
+            Limit(const Limit& copy)
+                : _module(copy._module)
+                , _category(copy._category)
+                , _rate(copy._rate)
+                , _burst(copy._burst)
+                , _sample(copy._sample)
+                , _tokens(copy._tokens)
+                , _refilled(copy._refilled)
+                , _counter(copy._counter)
+                , _suppressed(copy._suppressed)
+                , _categories(copy._categories)
+            {
+            }
+            ~Limit()
+            {
+            }
+
+        public:
+            inline bool operator==(const std::pair<const char*, const char*>& rhs) const
+            {
+                return ((_module == rhs.first) && (_category == rhs.second));
+            }
+            inline const string& Module() const
+            {
+                return (_module);
+            }
+            inline const string& Category() const
+            {
+                return (_category);
+            }
+            inline uint32_t Rate() const
+            {
+                return (_rate);
+            }
+            inline uint32_t Burst() const
+            {
+                return (_burst);
+            }
+            inline uint32_t Sample() const
+            {
+                return (_sample);
+            }
+            inline uint32_t Suppressed() const
+            {
+                return (_suppressed);
+            }
+            // What a limit for all categories suppressed of the given one.
+            inline uint32_t Suppressed(const string& category) const
+            {
+                std::map<string, uint32_t>::const_iterator index(_categories.find(category));
+
+                return (index != _categories.end() ? index->second : 0);
+            }
+            void Update(const uint32_t rate, const uint32_t burst, const uint32_t sample)
+            {
+                _rate = rate;
+                _burst = (burst > 0 ? burst : (rate > 0 ? rate : 1));
+                _sample = sample;
+                _tokens = std::min(_tokens, static_cast<uint64_t>(_burst) * Token);
+                _counter = 0;
+            }
+            bool Allow(const uint64_t timestamp, const char category[])
+            {
+                bool result = true;
+
+                if ((_sample > 1) && ((_counter++ % _sample) != 0)) {
+                    result = false;
+                } else if (_rate > 0) {
+                    uint64_t capacity = static_cast<uint64_t>(_burst) * Token;
+
+                    if (timestamp > _refilled) {
+                        if (_refilled != 0) {
+                            uint64_t tokens = _tokens + ((timestamp - _refilled) * _rate);
+                            _tokens = (tokens > capacity ? capacity : tokens);
+                        }
+                        _refilled = timestamp;
+                    }
+
+                    if (_tokens >= Token) {
+                        _tokens -= Token;
+                    } else {
+                        result = false;
+                    }
+                }
+
+                if (result == false) {
+                    _suppressed++;
+
+                    if (_category.empty() == true) {
+                        _categories[category]++;
+                    }
+                }
+
+                return (result);
+            }
+
+        private:
+            string _module;
+            string _category;
+            uint32_t _rate;
+            uint32_t _burst;
+            uint32_t _sample;
+            uint64_t _tokens;
+            uint64_t _refilled;
+            uint32_t _counter;
+            uint32_t _suppressed;
+            std::map<string, uint32_t> _categories;
+        };
+
+    public:
+        TraceThrottle()
+            : _adminLock()
+            , _limits()
+            , _active(0)
+        {
+        }
+        ~TraceThrottle()
+        {
+        }
+
+    public:
+        // A rate and a sample of 0 remove the limit.
+        void Set(const string& module, const string& category, const uint32_t rate, const uint32_t burst, const uint32_t sample)
+        {
+            _adminLock.Lock();
+
+            std::list<Limit>::iterator index(std::find(_limits.begin(), _limits.end(), std::pair<const char*, const char*>(module.c_str(), category.c_str())));
+
+            if ((rate == 0) && (sample <= 1)) {
+                if (index != _limits.end()) {
+                    _limits.erase(index);
+                }
+            } else if (index != _limits.end()) {
+                index->Update(rate, burst, sample);
+            } else {
+                _limits.push_back(Limit(module, category, rate, burst, sample));
+            }
+
+            _active = static_cast<uint32_t>(_limits.size());
+
+            _adminLock.Unlock();
+        }
+        // Returns false, and no limit at all, if the module/category is not limited on its own.
+        bool Get(const string& module, const string& category, uint32_t& rate, uint32_t& burst, uint32_t& sample) const
+        {
+            _adminLock.Lock();
+
+            std::list<Limit>::const_iterator index(std::find(_limits.begin(), _limits.end(), std::pair<const char*, const char*>(module.c_str(), category.c_str())));
+            bool result = (index != _limits.end());
+
+            rate = (result == true ? index->Rate() : 0);
+            burst = (result == true ? index->Burst() : 0);
+            sample = (result == true ? index->Sample() : 0);
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+        // What the limit of the category and the limit for all categories of the module suppressed of it.
+        uint32_t Suppressed(const string& module, const string& category) const
+        {
+            uint32_t result = 0;
+
+            _adminLock.Lock();
+
+            std::list<Limit>::const_iterator index(std::find(_limits.begin(), _limits.end(), std::pair<const char*, const char*>(module.c_str(), category.c_str())));
+
+            if (index != _limits.end()) {
+                result = index->Suppressed();
+            }
+
+            index = std::find(_limits.begin(), _limits.end(), std::pair<const char*, const char*>(module.c_str(), ""));
+
+            if ((category.empty() == false) && (index != _limits.end())) {
+                result += index->Suppressed(category);
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+        template <typename ACTION>
+        void Visit(ACTION action) const
+        {
+            _adminLock.Lock();
+
+            std::list<Limit>::const_iterator index(_limits.begin());
+
+            while (index != _limits.end()) {
+                action(*index);
+                index++;
+            }
+
+            _adminLock.Unlock();
+        }
+
+        // Called from the trace worker for every entry, so without any limit this should cost next to nothing.
+        bool Allow(const uint64_t timestamp, const char module[], const char category[])
+        {
+            bool result = true;
+
+            if (_active.load(std::memory_order_relaxed) != 0) {
+                _adminLock.Lock();
+
+                std::list<Limit>::iterator index(std::find(_limits.begin(), _limits.end(), std::pair<const char*, const char*>(module, category)));
+
+                if (index == _limits.end()) {
+                    index = std::find(_limits.begin(), _limits.end(), std::pair<const char*, const char*>(module, ""));
+                }
+
+                if (index != _limits.end()) {
+                    result = index->Allow(timestamp, category);
+                }
+
+                _adminLock.Unlock();
+            }
+
+            return (result);
+        }
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        std::list<Limit> _limits;
+        std::atomic<uint32_t> _active;
+    };
+}
+}
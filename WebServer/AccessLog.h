@@ -0,0 +1,259 @@
+#ifndef __WEBSERVER_ACCESSLOG_H
+#define __WEBSERVER_ACCESSLOG_H
+
+#include "Module.h"
+
+#ifndef __WIN32__
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Writes a JSON object per served request, one per line, to a file. The channels append their lines to
+    // a buffer, a thread of its own swaps it for an empty one and appends it to the file in one write, so a
+    // slow disk never holds up the network. Lines that do not fit in the buffer while the file is being
+    // written are dropped and counted, never waited for.
+    class AccessLog : private Core::Thread {
+    public:
+        // Bytes of lines that can wait for the file, per buffer.
+        static constexpr uint32_t BufferSize = 64 * 1024;
+        // Maximum length of a single line, the path is cut short to make it fit.
+        static constexpr uint32_t LineSize = 512;
+
+        struct Entry {
+            uint64_t Time; // Ticks at which the request came in
+            string Remote;
+            string Method;
+            string Path;
+            string Route;
+            uint16_t Status;
+            uint64_t Bytes;
+            uint64_t FirstByte;
+            uint64_t Total;
+        };
+
+    private:
+        AccessLog(const AccessLog&) = delete;
+        AccessLog& operator=(const AccessLog&) = delete;
+
+        struct Line {
+            uint16_t Length;
+            char Text[LineSize];
+        };
+
+    public:
+        AccessLog()
+            : Core::Thread(Core::Thread::DefaultStackSize(), _T("AccessLog"))
+            , _adminLock()
+            , _signal(false, true)
+            , _file(-1)
+            , _filling()
+            , _writing()
+            , _queued(0)
+            , _written(0)
+            , _dropped(0)
+        {
+            _filling.reserve(BufferSize);
+            _writing.reserve(BufferSize);
+        }
+        ~AccessLog()
+        {
+            Close();
+        }
+
+    public:
+        inline bool IsOpen() const
+        {
+            return (_file != -1);
+        }
+        uint32_t Written() const
+        {
+            _adminLock.Lock();
+            const uint32_t result = _written;
+            _adminLock.Unlock();
+
+            return (result);
+        }
+        uint32_t Dropped() const
+        {
+            _adminLock.Lock();
+            const uint32_t result = _dropped;
+            _adminLock.Unlock();
+
+            return (result);
+        }
+        // Lines are appended to what is in the file already.
+        uint32_t Open(const string& fileName)
+        {
+            uint32_t result = Core::ERROR_UNAVAILABLE;
+
+            ASSERT(IsOpen() == false);
+#ifndef __WIN32__
+            _file = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+            if (_file != -1) {
+                Run();
+                result = Core::ERROR_NONE;
+            }
+#endif
+            return (result);
+        }
+        void Close()
+        {
+            if (IsOpen() == true) {
+                Block();
+                _signal.SetEvent();
+                Wait(Thread::BLOCKED | Thread::STOPPED | Thread::STOPPING, Core::infinite);
+
+                // The lines of the last requests still go to the file.
+                Flush();
+#ifndef __WIN32__
+                ::close(_file);
+#endif
+                _file = -1;
+            }
+        }
+        void Log(const Entry& entry)
+        {
+            Line line;
+            char route[64];
+
+            Escape(entry.Route, route, sizeof(route));
+
+            int length = Format(line, entry, route, LineSize / 2);
+
+            if ((length > 0) && (static_cast<uint32_t>(length) >= sizeof(line.Text))) {
+                // Too long, the path gives up what is too much, so the line stays a JSON object.
+                const uint32_t excess = static_cast<uint32_t>(length) - sizeof(line.Text) + 8;
+
+                length = (excess < (LineSize / 2) ? Format(line, entry, route, (LineSize / 2) - excess) : -1);
+            }
+
+            _adminLock.Lock();
+
+            if ((length <= 0) || (static_cast<uint32_t>(length) >= sizeof(line.Text)) || ((_filling.size() + length) > BufferSize)) {
+                _dropped++;
+            } else {
+                _filling.append(line.Text, length);
+                _queued++;
+                _signal.SetEvent();
+            }
+
+            _adminLock.Unlock();
+        }
+
+    private:
+        // The path is given at most the room passed, returns what snprintf returns.
+        static int Format(Line& line, const Entry& entry, const char route[], const uint32_t room)
+        {
+            char path[LineSize / 2];
+
+            ASSERT(room <= sizeof(path));
+
+            Escape(entry.Path, path, room);
+
+            return (snprintf(line.Text, sizeof(line.Text),
+                "{\"time\":%llu,\"remote\":\"%s\",\"method\":\"%s\",\"path\":\"%s\",\"route\":\"%s\",\"status\":%u,\"bytes\":%llu,\"ttfb\":%llu,\"total\":%llu}\n",
+                static_cast<unsigned long long>(entry.Time), entry.Remote.c_str(), entry.Method.c_str(), path, route, entry.Status,
+                static_cast<unsigned long long>(entry.Bytes), static_cast<unsigned long long>(entry.FirstByte), static_cast<unsigned long long>(entry.Total)));
+        }
+        // Copies the text as the content of a JSON string, as far as it fits, never ending halfway a UTF-8 sequence.
+        static void Escape(const string& text, char buffer[], const uint32_t size)
+        {
+            static const char hex[] = "0123456789abcdef";
+            uint32_t length = 0;
+            string::const_iterator index(text.begin());
+
+            while ((index != text.end()) && ((length + 7) < size)) {
+                const unsigned char c = static_cast<unsigned char>(*index);
+
+                if ((c == '"') || (c == '\\')) {
+                    buffer[length++] = '\\';
+                    buffer[length++] = c;
+                } else if (c < 0x20) {
+                    buffer[length++] = '\\';
+                    buffer[length++] = 'u';
+                    buffer[length++] = '0';
+                    buffer[length++] = '0';
+                    buffer[length++] = hex[c >> 4];
+                    buffer[length++] = hex[c & 0xF];
+                } else {
+                    buffer[length++] = c;
+                }
+                index++;
+            }
+
+            if (index != text.end()) {
+                // Cut short, drop the start of a sequence that did not fit completely.
+                while ((length > 0) && ((static_cast<unsigned char>(buffer[length - 1]) & 0xC0) == 0x80)) {
+                    length--;
+                }
+                if ((length > 0) && ((static_cast<unsigned char>(buffer[length - 1]) & 0xC0) == 0xC0)) {
+                    length--;
+                }
+            }
+
+            buffer[length] = '\0';
+        }
+        virtual uint32_t Worker()
+        {
+            while ((IsRunning() == true) && (_signal.Lock(Core::infinite) == Core::ERROR_NONE)) {
+                _signal.ResetEvent();
+
+                Flush();
+            }
+
+            return (Core::infinite);
+        }
+        // Takes what the channels filled, they go on with the other buffer while this one is written.
+        void Flush()
+        {
+            uint32_t lines;
+
+            _adminLock.Lock();
+            _filling.swap(_writing);
+            lines = _queued;
+            _queued = 0;
+            _adminLock.Unlock();
+
+            if (_writing.empty() == false) {
+#ifndef __WIN32__
+                size_t offset = 0;
+                bool failed = false;
+
+                while ((failed == false) && (offset < _writing.size())) {
+                    const ssize_t result = ::write(_file, &(_writing[offset]), _writing.size() - offset);
+
+                    if (result >= 0) {
+                        offset += static_cast<size_t>(result);
+                    } else {
+                        // If the file is gone there is nothing else to do, these lines are lost.
+                        failed = (errno != EINTR);
+                    }
+                }
+#endif
+                _writing.clear();
+
+                _adminLock.Lock();
+                _written += lines;
+                _adminLock.Unlock();
+            }
+        }
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        Core::Event _signal;
+        int _file;
+        string _filling;
+        string _writing;
+        uint32_t _queued;
+        uint32_t _written;
+        uint32_t _dropped;
+    };
+}
+}
+
+#endif // __WEBSERVER_ACCESSLOG_H
@@ -0,0 +1,428 @@
+#ifndef __WEBSERVER_ASSETCACHE_H
+#define __WEBSERVER_ASSETCACHE_H
+
+#include "Module.h"
+
+#ifndef __WIN32__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Keeps the content of the most recently served files in memory, least recently used files are dropped once
+    // the configured capacity is exceeded. Every file gets a strong validator (ETag) derived from its content.
+    // The directories holding cached files are watched through inotify, so a file that changes on disk is
+    // dropped from the cache right away. Without inotify, every hit is checked against the file on disk.
+    // Whether a file exists is remembered the same way, for files that are looked for but not served from
+    // memory, like the precompressed variants.
+    class AssetCache {
+    public:
+        // Files of which the existence is remembered, beyond this all are forgotten at once.
+        static constexpr uint32_t MaxKnown = 4096;
+
+        struct Asset {
+            string Content;
+            string ETag;
+            Core::Time Modified;
+        };
+
+    private:
+        AssetCache(const AssetCache&) = delete;
+        AssetCache& operator=(const AssetCache&) = delete;
+
+        class Watcher : public Core::IResource {
+        public:
+            Watcher() = delete;
+            Watcher(const Watcher&) = delete;
+            Watcher& operator=(const Watcher&) = delete;
+
+            Watcher(AssetCache& parent)
+                : _parent(parent)
+                , _descriptor(-1)
+            {
+#ifndef __WIN32__
+                _descriptor = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+                if (_descriptor != -1) {
+                    Core::ResourceMonitor::Instance().Register(*this);
+                }
+#endif
+            }
+            ~Watcher() override
+            {
+#ifndef __WIN32__
+                if (_descriptor != -1) {
+                    Core::ResourceMonitor::Instance().Unregister(*this);
+                    ::close(_descriptor);
+                    _descriptor = -1;
+                }
+#endif
+            }
+
+        public:
+            inline bool IsValid() const
+            {
+                return (_descriptor != -1);
+            }
+            Core::IResource::handle Descriptor() const override
+            {
+                return (_descriptor);
+            }
+
+        private:
+            uint16_t Events() override
+            {
+                return (_descriptor != -1 ? POLLIN : 0);
+            }
+            void Handle(const uint16_t events) override
+            {
+                if ((events & POLLIN) != 0) {
+                    _parent.Changed();
+                }
+            }
+
+        private:
+            AssetCache& _parent;
+            int _descriptor;
+        };
+
+        struct Entry {
+            string FileName;
+            Asset Content;
+        };
+
+        typedef std::list<Entry> Entries;
+
+    public:
+        AssetCache()
+            : _adminLock()
+            , _entries()
+            , _index()
+            , _known()
+            , _directories()
+            , _size(0)
+            , _capacity(0)
+            , _maxFileSize(0)
+            , _watcher(*this)
+        {
+        }
+        ~AssetCache()
+        {
+        }
+
+    public:
+        // Capacity and file size in bytes, a capacity of 0 disables the cache.
+        void Configure(const uint32_t capacity, const uint32_t maxFileSize)
+        {
+            _adminLock.Lock();
+
+            _capacity = capacity;
+            _maxFileSize = std::min(maxFileSize, capacity);
+
+            Evict();
+
+            _adminLock.Unlock();
+        }
+        void Clear()
+        {
+            _adminLock.Lock();
+
+            _entries.clear();
+            _index.clear();
+            _known.clear();
+            _size = 0;
+
+            _adminLock.Unlock();
+        }
+        // Is the file there? Only with inotify the answer is kept, until something changes in its directory.
+        bool Exists(const string& fileName)
+        {
+            bool result = false;
+
+            _adminLock.Lock();
+
+            std::map<string, bool>::const_iterator index(_known.find(fileName));
+
+            if (index != _known.end()) {
+                result = index->second;
+            } else {
+                // Watch first, so a change while we look is not missed.
+                const bool watched = Watch(fileName);
+#ifndef __WIN32__
+                struct stat info;
+
+                result = ((::stat(fileName.c_str(), &info) == 0) && (S_ISREG(info.st_mode)));
+#endif
+                if (watched == true) {
+                    if (_known.size() >= MaxKnown) {
+                        _known.clear();
+                    }
+
+                    _known.insert(std::pair<string, bool>(fileName, result));
+                }
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+        // Hands the asset of the given file to the action, while the cache is locked. Returns false, without
+        // calling the action, if the file can not be served from the cache: it is too big or can not be read.
+        template <typename ACTION>
+        bool Use(const string& fileName, ACTION action)
+        {
+            bool result = false;
+
+            _adminLock.Lock();
+
+            if (_capacity != 0) {
+                std::map<string, Entries::iterator>::iterator index(_index.find(fileName));
+
+                if ((index != _index.end()) && (_watcher.IsValid() == false) && (IsCurrent(*(index->second)) == false)) {
+                    Remove(index);
+                    index = _index.end();
+                }
+
+                if (index != _index.end()) {
+                    // Most recently used goes up front.
+                    _entries.splice(_entries.begin(), _entries, index->second);
+                    result = true;
+                } else {
+                    Entry entry;
+
+                    entry.FileName = fileName;
+
+                    // Watch first, so a change while the file is read is not missed.
+                    Watch(fileName);
+
+                    if (Load(fileName, _maxFileSize, entry.Content) == true) {
+                        _size += static_cast<uint32_t>(entry.Content.Content.length());
+                        _entries.push_front(std::move(entry));
+                        _index.insert(std::pair<string, Entries::iterator>(fileName, _entries.begin()));
+
+                        Evict();
+
+                        result = (_entries.empty() == false) && (_entries.front().FileName == fileName);
+                    }
+                }
+
+                if (result == true) {
+                    action(static_cast<const Asset&>(_entries.front().Content));
+                }
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+
+    private:
+        static bool Load(const string& fileName, const uint32_t maxFileSize, Asset& asset)
+        {
+            bool result = false;
+#ifndef __WIN32__
+            struct stat info;
+
+            // Files that are too big are not even opened, they are looked at on every request.
+            int fd = (((::stat(fileName.c_str(), &info) == 0) && (S_ISREG(info.st_mode)) && (static_cast<uint64_t>(info.st_size) <= maxFileSize)) ? ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC) : -1);
+
+            if (fd != -1) {
+                if ((::fstat(fd, &info) == 0) && (S_ISREG(info.st_mode)) && (static_cast<uint64_t>(info.st_size) <= maxFileSize)) {
+                    ssize_t length = 0;
+                    uint32_t loaded = 0;
+
+                    asset.Content.resize(static_cast<size_t>(info.st_size));
+
+                    while ((loaded < asset.Content.length()) && ((length = ::read(fd, &(asset.Content[loaded]), asset.Content.length() - loaded)) > 0)) {
+                        loaded += static_cast<uint32_t>(length);
+                    }
+
+                    if (loaded == asset.Content.length()) {
+                        asset.Modified = Core::Time(Ticks(info));
+                        asset.ETag = Tag(asset.Content);
+                        result = true;
+                    }
+                }
+
+                ::close(fd);
+            }
+#endif
+            return (result);
+        }
+        // A strong validator: the size and a 64 bit FNV-1a hash of the content.
+        static string Tag(const string& content)
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            char buffer[48];
+
+            for (string::const_iterator index(content.begin()); index != content.end(); index++) {
+                hash = (hash ^ static_cast<uint8_t>(*index)) * 1099511628211ULL;
+            }
+
+            ::snprintf(buffer, sizeof(buffer), "\"%llx-%016llx\"", static_cast<unsigned long long>(content.length()), static_cast<unsigned long long>(hash));
+
+            return (string(buffer));
+        }
+#ifndef __WIN32__
+        static uint64_t Ticks(const struct stat& info)
+        {
+            return ((static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000 * 1000) + (info.st_mtim.tv_nsec / 1000));
+        }
+#endif
+        // Only used if there is no inotify, compares the file on disk with what we have.
+        static bool IsCurrent(const Entry& entry)
+        {
+            bool result = false;
+#ifndef __WIN32__
+            struct stat info;
+
+            result = ((::stat(entry.FileName.c_str(), &info) == 0) && (static_cast<uint64_t>(info.st_size) == entry.Content.Content.length()) && (Ticks(info) == entry.Content.Modified.Ticks()));
+#endif
+            return (result);
+        }
+        void Remove(std::map<string, Entries::iterator>::iterator& index)
+        {
+            _size -= static_cast<uint32_t>(index->second->Content.Content.length());
+            _entries.erase(index->second);
+            index = _index.erase(index);
+        }
+        void Evict()
+        {
+            while ((_size > _capacity) && (_entries.empty() == false)) {
+                std::map<string, Entries::iterator>::iterator index(_index.find(_entries.back().FileName));
+
+                ASSERT(index != _index.end());
+
+                Remove(index);
+            }
+        }
+        // Returns true if the directory of the file is watched.
+        bool Watch(const string& fileName)
+        {
+            bool result = false;
+#ifndef __WIN32__
+            size_t slash = fileName.find_last_of('/');
+
+            if ((_watcher.IsValid() == true) && (slash != string::npos)) {
+                string directory(fileName.substr(0, slash));
+                std::map<int, string>::const_iterator index(_directories.begin());
+
+                while ((index != _directories.end()) && (index->second != directory)) {
+                    index++;
+                }
+
+                if (index == _directories.end()) {
+                    int wd = ::inotify_add_watch(_watcher.Descriptor(), (directory.empty() == true ? "/" : directory.c_str()),
+                        IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+
+                    if (wd != -1) {
+                        _directories[wd] = directory;
+                        result = true;
+                    }
+                } else {
+                    result = true;
+                }
+            }
+#endif
+            return (result);
+        }
+        // Drops the files within the directory (but not in its subdirectories) or just the named file.
+        void Invalidate(const string& directory, const char name[])
+        {
+            const string prefix(directory + '/');
+            std::map<string, Entries::iterator>::iterator index(_index.lower_bound(prefix));
+
+            while ((index != _index.end()) && (index->first.compare(0, prefix.length(), prefix) == 0)) {
+                if (Within(index->first, prefix, name) == true) {
+                    Remove(index);
+                } else {
+                    index++;
+                }
+            }
+
+            std::map<string, bool>::iterator known(_known.lower_bound(prefix));
+
+            while ((known != _known.end()) && (known->first.compare(0, prefix.length(), prefix) == 0)) {
+                if (Within(known->first, prefix, name) == true) {
+                    known = _known.erase(known);
+                } else {
+                    known++;
+                }
+            }
+        }
+        static bool Within(const string& fileName, const string& prefix, const char name[])
+        {
+            const string file(fileName.substr(prefix.length()));
+
+            return (((name == nullptr) && (file.find('/') == string::npos)) || ((name != nullptr) && (file == name)));
+        }
+        // Called from the resource monitor, if inotify has something to report.
+        void Changed()
+        {
+#ifndef __WIN32__
+            char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+            ssize_t length;
+
+            _adminLock.Lock();
+
+            while ((length = ::read(_watcher.Descriptor(), buffer, sizeof(buffer))) > 0) {
+                const char* position = buffer;
+
+                while (position < (buffer + length)) {
+                    const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(position);
+
+                    if ((event->mask & IN_Q_OVERFLOW) != 0) {
+                        // We lost track, start all over.
+                        _entries.clear();
+                        _index.clear();
+                        _known.clear();
+                        _size = 0;
+                    } else {
+                        std::map<int, string>::iterator index(_directories.find(event->wd));
+
+                        if (index != _directories.end()) {
+                            if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) != 0) {
+                                // The watch follows the directory, not its path. Let go of it, so the path is
+                                // watched again, whatever directory is there the next time it is used.
+                                Invalidate(index->second, nullptr);
+
+                                if ((event->mask & IN_IGNORED) == 0) {
+                                    ::inotify_rm_watch(_watcher.Descriptor(), event->wd);
+                                }
+
+                                _directories.erase(index);
+                            } else if (event->len > 0) {
+                                Invalidate(index->second, event->name);
+                            }
+                        }
+                    }
+
+                    position += sizeof(struct inotify_event) + event->len;
+                }
+            }
+
+            _adminLock.Unlock();
+#endif
+        }
+
+    private:
+        Core::CriticalSection _adminLock;
+        Entries _entries;
+        std::map<string, Entries::iterator> _index;
+        std::map<string, bool> _known;
+        std::map<int, string> _directories;
+        uint32_t _size;
+        uint32_t _capacity;
+        uint32_t _maxFileSize;
+        Watcher _watcher;
+    };
+}
+}
+
+#endif // __WEBSERVER_ASSETCACHE_H
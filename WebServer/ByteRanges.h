@@ -0,0 +1,149 @@
+#ifndef __WEBSERVER_BYTERANGES_H
+#define __WEBSERVER_BYTERANGES_H
+
+#include "Module.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Parses the value of a Range header ("bytes=0-499,1000-,-500") against the size of the representation.
+    // Ranges are returned sorted, with overlapping and adjacent ones merged, so no byte is sent twice. A
+    // header that can not be parsed, or asks for a suspicious number of ranges, is ignored: the whole
+    // representation is sent, as allowed by RFC 7233.
+    class ByteRanges {
+    public:
+        static constexpr uint8_t MaxRanges = 16;
+
+        enum state : uint8_t {
+            ENTIRE,
+            PARTIAL,
+            UNSATISFIABLE
+        };
+
+        struct Range {
+            uint64_t First;
+            uint64_t Last; // Inclusive
+
+            inline uint64_t Length() const
+            {
+                return (Last - First + 1);
+            }
+        };
+
+    public:
+        ByteRanges() = delete;
+        ByteRanges(const ByteRanges&) = delete;
+        ByteRanges& operator=(const ByteRanges&) = delete;
+
+        static state Parse(const string& header, const uint64_t size, std::vector<Range>& ranges)
+        {
+            state result = UNSATISFIABLE;
+            size_t position = header.find('=');
+
+            ranges.clear();
+
+            if ((position == string::npos) || (Trim(header.substr(0, position)) != _T("bytes"))) {
+                result = ENTIRE;
+            } else {
+                position++;
+
+                while ((result != ENTIRE) && (position <= header.length())) {
+                    size_t end = header.find(',', position);
+                    const string spec(Trim(header.substr(position, end == string::npos ? string::npos : end - position)));
+                    const size_t dash = spec.find('-');
+                    uint64_t first = 0;
+                    uint64_t last = 0;
+
+                    if ((dash == string::npos) || ((dash == 0) && (spec.length() == 1))) {
+                        result = ENTIRE;
+                    } else if (dash == 0) {
+                        // A suffix: the last n bytes.
+                        if (Number(spec.substr(1), last) == false) {
+                            result = ENTIRE;
+                        } else if ((last > 0) && (size > 0)) {
+                            Add(ranges, (last < size ? size - last : 0), size - 1);
+                        }
+                    } else if ((Number(spec.substr(0, dash), first) == false) || ((dash + 1 < spec.length()) && ((Number(spec.substr(dash + 1), last) == false) || (last < first)))) {
+                        result = ENTIRE;
+                    } else if (first < size) {
+                        Add(ranges, first, ((dash + 1 == spec.length()) || (last >= size)) ? size - 1 : last);
+                    }
+
+                    if (ranges.size() > (MaxRanges * 4)) {
+                        // Way past the limit, no need to look any further.
+                        result = ENTIRE;
+                    }
+
+                    position = (end == string::npos ? header.length() + 1 : end + 1);
+                }
+
+                if (result != ENTIRE) {
+                    Merge(ranges);
+
+                    if (ranges.size() > MaxRanges) {
+                        result = ENTIRE;
+                    } else if (ranges.empty() == false) {
+                        result = PARTIAL;
+                    }
+                }
+            }
+
+            if (result != PARTIAL) {
+                ranges.clear();
+            }
+
+            return (result);
+        }
+
+    private:
+        static string Trim(const string& text)
+        {
+            const size_t first = text.find_first_not_of(_T(" \t"));
+
+            return (first == string::npos ? string() : text.substr(first, text.find_last_not_of(_T(" \t")) - first + 1));
+        }
+        static bool Number(const string& text, uint64_t& value)
+        {
+            bool result = ((text.empty() == false) && (text.length() <= 19));
+
+            value = 0;
+
+            for (string::const_iterator index(text.begin()); (result == true) && (index != text.end()); index++) {
+                result = ((*index >= '0') && (*index <= '9'));
+                value = (value * 10) + (*index - '0');
+            }
+
+            return (result);
+        }
+        static void Add(std::vector<Range>& ranges, const uint64_t first, const uint64_t last)
+        {
+            Range range;
+
+            range.First = first;
+            range.Last = last;
+            ranges.push_back(range);
+        }
+        static void Merge(std::vector<Range>& ranges)
+        {
+            std::sort(ranges.begin(), ranges.end(), [](const Range& lhs, const Range& rhs) { return (lhs.First < rhs.First); });
+
+            if (ranges.empty() == false) {
+                std::vector<Range>::iterator target(ranges.begin());
+
+                for (std::vector<Range>::const_iterator index(ranges.begin() + 1); index != ranges.end(); index++) {
+                    if (index->First <= (target->Last + 1)) {
+                        target->Last = std::max(target->Last, index->Last);
+                    } else {
+                        target++;
+                        *target = *index;
+                    }
+                }
+
+                ranges.erase(target + 1, ranges.end());
+            }
+        }
+    };
+}
+}
+
+#endif // __WEBSERVER_BYTERANGES_H
@@ -0,0 +1,294 @@
+#ifndef __WEBSERVER_FIELDS_H
+#define __WEBSERVER_FIELDS_H
+
+#include "Module.h"
+
+#include <type_traits>
+
+namespace WPEFramework {
+namespace Plugin {
+
+// Generates the accessors of a header field that the framework may have as text. Where it has not, or has
+// it as something else, the getter reports the field as absent and the setter reports it could not be set.
+#define WEBSERVER_TEXT_FIELD(NAME)                                                                                   \
+private:                                                                                                             \
+    template <typename MESSAGE>                                                                                      \
+    static auto NAME(const MESSAGE& message, string& value, int)                                                     \
+        -> typename std::enable_if<std::is_same<typename std::decay<decltype(message.NAME.Value())>::type, string>::value, bool>::type \
+    {                                                                                                                \
+        bool result = (message.NAME.IsSet() == true);                                                                \
+                                                                                                                     \
+        if (result == true) {                                                                                        \
+            value = message.NAME.Value();                                                                            \
+        }                                                                                                            \
+                                                                                                                     \
+        return (result);                                                                                             \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static bool NAME(const MESSAGE&, string&, long)                                                                  \
+    {                                                                                                                \
+        return (false);                                                                                              \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static auto Set##NAME(MESSAGE& message, const string& value, int)                                                \
+        -> typename std::enable_if<std::is_same<typename std::decay<decltype(message.NAME.Value())>::type, string>::value, bool>::type \
+    {                                                                                                                \
+        message.NAME = value;                                                                                        \
+                                                                                                                     \
+        return (true);                                                                                               \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static bool Set##NAME(MESSAGE&, const string&, long)                                                             \
+    {                                                                                                                \
+        return (false);                                                                                              \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static constexpr auto Has##NAME(int)                                                                             \
+        -> typename std::enable_if<std::is_same<typename std::decay<decltype(std::declval<const MESSAGE&>().NAME.Value())>::type, string>::value, bool>::type \
+    {                                                                                                                \
+        return (true);                                                                                               \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static constexpr bool Has##NAME(long)                                                                            \
+    {                                                                                                                \
+        return (false);                                                                                              \
+    }                                                                                                                \
+                                                                                                                     \
+public:                                                                                                              \
+    template <typename MESSAGE>                                                                                      \
+    static constexpr bool Has##NAME()                                                                                \
+    {                                                                                                                \
+        return (Has##NAME<MESSAGE>(0));                                                                              \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static bool NAME(const MESSAGE& message, string& value)                                                          \
+    {                                                                                                                \
+        return (NAME(message, value, 0));                                                                            \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static bool Set##NAME(MESSAGE& message, const string& value)                                                     \
+    {                                                                                                                \
+        return (Set##NAME(message, value, 0));                                                                       \
+    }
+
+// Same, for the fields the framework has as a point in time.
+#define WEBSERVER_TIME_FIELD(NAME)                                                                                   \
+private:                                                                                                             \
+    template <typename MESSAGE>                                                                                      \
+    static auto NAME(const MESSAGE& message, Core::Time& value, int)                                                 \
+        -> typename std::enable_if<std::is_same<typename std::decay<decltype(message.NAME.Value())>::type, Core::Time>::value, bool>::type \
+    {                                                                                                                \
+        bool result = (message.NAME.IsSet() == true);                                                                \
+                                                                                                                     \
+        if (result == true) {                                                                                        \
+            value = message.NAME.Value();                                                                            \
+        }                                                                                                            \
+                                                                                                                     \
+        return (result);                                                                                             \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static bool NAME(const MESSAGE&, Core::Time&, long)                                                              \
+    {                                                                                                                \
+        return (false);                                                                                              \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static auto Set##NAME(MESSAGE& message, const Core::Time& value, int)                                            \
+        -> typename std::enable_if<std::is_same<typename std::decay<decltype(message.NAME.Value())>::type, Core::Time>::value, bool>::type \
+    {                                                                                                                \
+        message.NAME = value;                                                                                        \
+                                                                                                                     \
+        return (true);                                                                                               \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static bool Set##NAME(MESSAGE&, const Core::Time&, long)                                                         \
+    {                                                                                                                \
+        return (false);                                                                                              \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static constexpr auto Has##NAME(int)                                                                             \
+        -> typename std::enable_if<std::is_same<typename std::decay<decltype(std::declval<const MESSAGE&>().NAME.Value())>::type, Core::Time>::value, bool>::type \
+    {                                                                                                                \
+        return (true);                                                                                               \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static constexpr bool Has##NAME(long)                                                                            \
+    {                                                                                                                \
+        return (false);                                                                                              \
+    }                                                                                                                \
+                                                                                                                     \
+public:                                                                                                              \
+    template <typename MESSAGE>                                                                                      \
+    static constexpr bool Has##NAME()                                                                                \
+    {                                                                                                                \
+        return (Has##NAME<MESSAGE>(0));                                                                              \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static bool NAME(const MESSAGE& message, Core::Time& value)                                                      \
+    {                                                                                                                \
+        return (NAME(message, value, 0));                                                                            \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static bool Set##NAME(MESSAGE& message, const Core::Time& value)                                                 \
+    {                                                                                                                \
+        return (Set##NAME(message, value, 0));                                                                       \
+    }
+
+// A content coding the framework may have as text, or as its EncodingType, which only knows gzip. As an
+// EncodingType, the getter gives "gzip" for ENCODING_GZIP and the setter only takes "gzip".
+#define WEBSERVER_CODING_FIELD(NAME)                                                                                 \
+    WEBSERVER_TEXT_FIELD(NAME)                                                                                       \
+                                                                                                                     \
+private:                                                                                                             \
+    template <typename MESSAGE>                                                                                      \
+    static auto NAME(const MESSAGE& message, string& value, int)                                                     \
+        -> typename std::enable_if<Coding<typename std::decay<decltype(message.NAME.Value())>::type>::value, bool>::type \
+    {                                                                                                                \
+        typedef typename std::decay<decltype(message.NAME.Value())>::type coding;                                    \
+                                                                                                                     \
+        bool result = ((message.NAME.IsSet() == true) && (message.NAME.Value() == coding::ENCODING_GZIP));           \
+                                                                                                                     \
+        if (result == true) {                                                                                        \
+            value = _T("gzip");                                                                                      \
+        }                                                                                                            \
+                                                                                                                     \
+        return (result);                                                                                             \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static auto Set##NAME(MESSAGE& message, const string& value, int)                                                \
+        -> typename std::enable_if<Coding<typename std::decay<decltype(message.NAME.Value())>::type>::value, bool>::type \
+    {                                                                                                                \
+        typedef typename std::decay<decltype(message.NAME.Value())>::type coding;                                    \
+                                                                                                                     \
+        bool result = (value == _T("gzip"));                                                                         \
+                                                                                                                     \
+        if (result == true) {                                                                                        \
+            message.NAME = coding::ENCODING_GZIP;                                                                    \
+        }                                                                                                            \
+                                                                                                                     \
+        return (result);                                                                                             \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static constexpr auto Has##NAME(int)                                                                             \
+        -> typename std::enable_if<Coding<typename std::decay<decltype(std::declval<const MESSAGE&>().NAME.Value())>::type>::value, bool>::type \
+    {                                                                                                                \
+        return (true);                                                                                               \
+    }
+
+// Copies a field, whatever its type, from one message to another if it is set in the first. Nothing happens
+// if the framework does not know the field.
+#define WEBSERVER_COPY_FIELD(NAME)                                                                                   \
+private:                                                                                                             \
+    template <typename MESSAGE>                                                                                      \
+    static auto Copy##NAME(const MESSAGE& from, MESSAGE& to, int) -> decltype(from.NAME.IsSet(), to.NAME = from.NAME, void()) \
+    {                                                                                                                \
+        if (from.NAME.IsSet() == true) {                                                                             \
+            to.NAME = from.NAME;                                                                                     \
+        }                                                                                                            \
+    }                                                                                                                \
+    template <typename MESSAGE>                                                                                      \
+    static void Copy##NAME(const MESSAGE&, MESSAGE&, long)                                                           \
+    {                                                                                                                \
+    }
+
+    // Access to the header fields of requests and responses that not every release of the framework parses.
+    // The WebServer builds against all of them, a feature that needs a field the framework does not have is
+    // simply not offered: no ranges without Range, no conditional GET without If-None-Match and so on. The
+    // Has<Field>() checks tell, at compile time, which of the fields the framework has.
+    class Fields {
+    private:
+        Fields() = delete;
+        Fields(const Fields&) = delete;
+        Fields& operator=(const Fields&) = delete;
+
+        // Tells the framework's EncodingType apart from other types a coding field could have.
+        template <typename TYPE, typename = void>
+        struct Coding : std::false_type {
+        };
+        template <typename TYPE>
+        struct Coding<TYPE, decltype(static_cast<void>(TYPE::ENCODING_GZIP))> : std::is_enum<TYPE> {
+        };
+
+        // Request
+        WEBSERVER_CODING_FIELD(AcceptEncoding)
+        WEBSERVER_TEXT_FIELD(Cookie)
+        WEBSERVER_TEXT_FIELD(IfNoneMatch)
+        WEBSERVER_TIME_FIELD(IfModifiedSince)
+        WEBSERVER_TEXT_FIELD(Range)
+        WEBSERVER_TEXT_FIELD(IfRange)
+
+        // Response
+        WEBSERVER_TEXT_FIELD(CacheControl)
+        WEBSERVER_CODING_FIELD(ContentEncoding)
+        WEBSERVER_TEXT_FIELD(ETag)
+        WEBSERVER_TIME_FIELD(Modified)
+        WEBSERVER_TEXT_FIELD(Vary)
+
+        // The end-to-end fields of a response, the ones a cache keeps and replays (RFC 7234, section 3.1).
+        WEBSERVER_COPY_FIELD(ContentType)
+        WEBSERVER_COPY_FIELD(ContentEncoding)
+        WEBSERVER_COPY_FIELD(ContentLanguage)
+        WEBSERVER_COPY_FIELD(ContentDisposition)
+        WEBSERVER_COPY_FIELD(CacheControl)
+        WEBSERVER_COPY_FIELD(ETag)
+        WEBSERVER_COPY_FIELD(Modified)
+        WEBSERVER_COPY_FIELD(Expires)
+        WEBSERVER_COPY_FIELD(Vary)
+        WEBSERVER_COPY_FIELD(Location)
+        WEBSERVER_COPY_FIELD(Link)
+        WEBSERVER_COPY_FIELD(AccessControlOrigin)
+        WEBSERVER_COPY_FIELD(AccessControlMethod)
+        WEBSERVER_COPY_FIELD(AccessControlHeaders)
+        WEBSERVER_COPY_FIELD(AccessControlMaxAge)
+        WEBSERVER_COPY_FIELD(AccessControlExposeHeaders)
+        WEBSERVER_COPY_FIELD(AccessControlCredentials)
+
+    public:
+        // Hop-by-hop fields, and the ones describing the body as it is framed (Content-Length), stay behind.
+        static void EndToEnd(const Web::Response& from, Web::Response& to)
+        {
+            CopyContentType(from, to, 0);
+            CopyContentEncoding(from, to, 0);
+            CopyContentLanguage(from, to, 0);
+            CopyContentDisposition(from, to, 0);
+            CopyCacheControl(from, to, 0);
+            CopyETag(from, to, 0);
+            CopyModified(from, to, 0);
+            CopyExpires(from, to, 0);
+            CopyVary(from, to, 0);
+            CopyLocation(from, to, 0);
+            CopyLink(from, to, 0);
+            CopyAccessControlOrigin(from, to, 0);
+            CopyAccessControlMethod(from, to, 0);
+            CopyAccessControlHeaders(from, to, 0);
+            CopyAccessControlMaxAge(from, to, 0);
+            CopyAccessControlExposeHeaders(from, to, 0);
+            CopyAccessControlCredentials(from, to, 0);
+        }
+        // The length of the body, 0 if the framework does not tell.
+        template <typename MESSAGE>
+        static uint64_t ContentLength(const MESSAGE& message)
+        {
+            return (ContentLength(message, 0));
+        }
+
+    private:
+        template <typename MESSAGE>
+        static auto ContentLength(const MESSAGE& message, int) -> decltype(static_cast<uint64_t>(message.ContentLength.Value()), uint64_t())
+        {
+            return (message.ContentLength.IsSet() == true ? static_cast<uint64_t>(message.ContentLength.Value()) : 0);
+        }
+        template <typename MESSAGE>
+        static uint64_t ContentLength(const MESSAGE&, long)
+        {
+            return (0);
+        }
+    };
+
+#undef WEBSERVER_TEXT_FIELD
+#undef WEBSERVER_TIME_FIELD
+#undef WEBSERVER_CODING_FIELD
+#undef WEBSERVER_COPY_FIELD
+}
+}
+
+#endif // __WEBSERVER_FIELDS_H
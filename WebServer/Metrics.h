@@ -0,0 +1,186 @@
+#ifndef __WEBSERVER_METRICS_H
+#define __WEBSERVER_METRICS_H
+
+#include "Module.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Counters and histograms of the requests served, per route: the path of a proxy, or the empty string
+    // for what the WebServer serves itself. Histograms have power of 2 buckets, bucket n counts the values
+    // below 2^n (and at least 2^(n-1)), so adding a value is cheap and they never grow. Percentiles are the
+    // upper bound of the bucket they fall in, i.e. accurate within a factor 2, plenty to find what is slow.
+    class Metrics {
+    public:
+        static constexpr uint8_t Buckets = 32;
+
+        class Histogram {
+        public:
+            Histogram()
+                : _count(0)
+                , _sum(0)
+                , _maximum(0)
+            {
+                ::memset(_buckets, 0, sizeof(_buckets));
+            }
+            Histogram(const Histogram& copy)
+                : _count(copy._count)
+                , _sum(copy._sum)
+                , _maximum(copy._maximum)
+            {
+                ::memcpy(_buckets, copy._buckets, sizeof(_buckets));
+            }
+            ~Histogram()
+            {
+            }
+
+            Histogram& operator=(const Histogram& RHS)
+            {
+                _count = RHS._count;
+                _sum = RHS._sum;
+                _maximum = RHS._maximum;
+                ::memcpy(_buckets, RHS._buckets, sizeof(_buckets));
+
+                return (*this);
+            }
+
+        public:
+            inline uint32_t Count() const
+            {
+                return (_count);
+            }
+            inline uint64_t Mean() const
+            {
+                return (_count == 0 ? 0 : _sum / _count);
+            }
+            inline uint64_t Maximum() const
+            {
+                return (_maximum);
+            }
+            inline uint32_t Bucket(const uint8_t index) const
+            {
+                ASSERT(index < Buckets);
+
+                return (_buckets[index]);
+            }
+            void Add(const uint64_t value)
+            {
+                uint8_t index = 0;
+
+                while ((index < (Buckets - 1)) && ((value >> index) != 0)) {
+                    index++;
+                }
+
+                _buckets[index]++;
+                _count++;
+                _sum += value;
+                _maximum = std::max(_maximum, value);
+            }
+            // Percentile as a number from 1 to 100.
+            uint64_t Percentile(const uint8_t percentile) const
+            {
+                const uint64_t wanted = ((static_cast<uint64_t>(_count) * percentile) + 99) / 100;
+                uint64_t seen = 0;
+                uint8_t index = 0;
+
+                while ((index < (Buckets - 1)) && ((seen + _buckets[index]) < wanted)) {
+                    seen += _buckets[index];
+                    index++;
+                }
+
+                return (_count == 0 ? 0 : std::min(_maximum, (index == 0 ? 0 : (static_cast<uint64_t>(1) << index) - 1)));
+            }
+
+        private:
+            uint32_t _count;
+            uint64_t _sum;
+            uint64_t _maximum;
+            uint32_t _buckets[Buckets];
+        };
+
+        struct Route {
+            uint32_t Requests;
+            uint32_t ClientErrors; // 4xx
+            uint32_t ServerErrors; // 5xx, and responses that were cut short
+            uint64_t Bytes;
+            Histogram FirstByte; // Microseconds from the request to the first byte of the response
+            Histogram Total; // Microseconds from the request to the last byte of the response
+            Histogram Size; // Bytes in the response body
+        };
+
+    private:
+        Metrics(const Metrics&) = delete;
+        Metrics& operator=(const Metrics&) = delete;
+
+    public:
+        Metrics()
+            : _adminLock()
+            , _routes()
+        {
+        }
+        ~Metrics()
+        {
+        }
+
+    public:
+        // A status of 0 means the response could not be completed.
+        void Add(const string& route, const uint16_t status, const uint64_t bytes, const uint64_t firstByte, const uint64_t total)
+        {
+            _adminLock.Lock();
+
+            Route& entry(Find(route));
+
+            entry.Requests++;
+
+            if ((status == 0) || (status >= 500)) {
+                entry.ServerErrors++;
+            } else if (status >= 400) {
+                entry.ClientErrors++;
+            }
+
+            entry.Bytes += bytes;
+            entry.FirstByte.Add(firstByte);
+            entry.Total.Add(total);
+            entry.Size.Add(bytes);
+
+            _adminLock.Unlock();
+        }
+        template <typename ACTION>
+        void Visit(ACTION action) const
+        {
+            _adminLock.Lock();
+
+            for (std::map<string, Route>::const_iterator index(_routes.begin()); index != _routes.end(); index++) {
+                action(index->first, index->second);
+            }
+
+            _adminLock.Unlock();
+        }
+
+    private:
+        Route& Find(const string& route)
+        {
+            std::map<string, Route>::iterator index(_routes.find(route));
+
+            if (index == _routes.end()) {
+                Route entry;
+
+                entry.Requests = 0;
+                entry.ClientErrors = 0;
+                entry.ServerErrors = 0;
+                entry.Bytes = 0;
+
+                index = _routes.insert(std::pair<string, Route>(route, entry)).first;
+            }
+
+            return (index->second);
+        }
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        std::map<string, Route> _routes;
+    };
+}
+}
+
+#endif // __WEBSERVER_METRICS_H
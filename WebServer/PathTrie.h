@@ -0,0 +1,168 @@
+#ifndef __WEBSERVER_PATHTRIE_H
+#define __WEBSERVER_PATHTRIE_H
+
+#include "Module.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Maps URL paths on elements, per path segment. A lookup returns the element of the longest registered
+    // prefix of the path, in segments, so "/a/b" matches "/a/b/c" but not "/a/bc". Empty segments are
+    // skipped, "/a//b/" is the same as "/a/b". A lookup costs the length of the path, whatever the number
+    // of elements. The trie is a plain value: copy it, change the copy and publish that, to let readers
+    // go on with the old one.
+    template <typename ELEMENT>
+    class PathTrieType {
+    private:
+        struct Node {
+            std::map<string, Node> Children;
+            ELEMENT Element;
+        };
+
+    public:
+        PathTrieType()
+            : _root()
+            , _count(0)
+        {
+        }
+        PathTrieType(const PathTrieType& copy)
+            : _root(copy._root)
+            , _count(copy._count)
+        {
+        }
+        ~PathTrieType()
+        {
+        }
+
+        PathTrieType& operator=(const PathTrieType& RHS)
+        {
+            _root = RHS._root;
+            _count = RHS._count;
+
+            return (*this);
+        }
+
+    public:
+        inline uint32_t Count() const
+        {
+            return (_count);
+        }
+        // Returns false if there is an element for the path already, it is left as it is.
+        bool Insert(const string& path, const ELEMENT& element)
+        {
+            Node* node = &_root;
+            size_t position = 0;
+            string segment;
+
+            while (Next(path, position, segment) == true) {
+                node = &(node->Children[segment]);
+            }
+
+            bool result = (node->Element == ELEMENT());
+
+            if (result == true) {
+                node->Element = element;
+                _count++;
+            }
+
+            return (result);
+        }
+        // Returns the element that was removed, an empty one if there was none.
+        ELEMENT Remove(const string& path)
+        {
+            ELEMENT result;
+
+            Remove(_root, path, 0, result);
+
+            if (result != ELEMENT()) {
+                _count--;
+            }
+
+            return (result);
+        }
+        ELEMENT Find(const string& path) const
+        {
+            const Node* node = &_root;
+            ELEMENT result(_root.Element);
+            size_t position = 0;
+            string segment;
+
+            while ((node != nullptr) && (Next(path, position, segment) == true)) {
+                typename std::map<string, Node>::const_iterator index(node->Children.find(segment));
+
+                if (index == node->Children.end()) {
+                    node = nullptr;
+                } else {
+                    node = &(index->second);
+
+                    if (node->Element != ELEMENT()) {
+                        result = node->Element;
+                    }
+                }
+            }
+
+            return (result);
+        }
+        template <typename ACTION>
+        void Visit(ACTION action) const
+        {
+            Visit(_root, action);
+        }
+
+    private:
+        static bool Next(const string& path, size_t& position, string& segment)
+        {
+            bool result = false;
+
+            if (position != string::npos) {
+                size_t start = path.find_first_not_of('/', position);
+
+                if (start == string::npos) {
+                    position = string::npos;
+                } else {
+                    position = path.find('/', start);
+                    segment = path.substr(start, position == string::npos ? string::npos : position - start);
+                    result = true;
+                }
+            }
+
+            return (result);
+        }
+        // Returns true if the node has nothing left and can go.
+        static bool Remove(Node& node, const string& path, size_t position, ELEMENT& removed)
+        {
+            string segment;
+
+            if (Next(path, position, segment) == false) {
+                removed = node.Element;
+                node.Element = ELEMENT();
+            } else {
+                typename std::map<string, Node>::iterator index(node.Children.find(segment));
+
+                if ((index != node.Children.end()) && (Remove(index->second, path, position, removed) == true)) {
+                    node.Children.erase(index);
+                }
+            }
+
+            return ((node.Children.empty() == true) && (node.Element == ELEMENT()));
+        }
+        template <typename ACTION>
+        static void Visit(const Node& node, ACTION& action)
+        {
+            if (node.Element != ELEMENT()) {
+                action(node.Element);
+            }
+
+            for (typename std::map<string, Node>::const_iterator index(node.Children.begin()); index != node.Children.end(); index++) {
+                Visit(index->second, action);
+            }
+        }
+
+    private:
+        Node _root;
+        uint32_t _count;
+    };
+}
+}
+
+#endif // __WEBSERVER_PATHTRIE_H
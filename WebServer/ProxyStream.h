@@ -0,0 +1,359 @@
+#ifndef __WEBSERVER_PROXYSTREAM_H
+#define __WEBSERVER_PROXYSTREAM_H
+
+#include "Module.h"
+
+#include <atomic>
+
+#ifndef __WIN32__
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Relays a request to an upstream server and passes its response on to the socket of a channel, as it
+    // comes in: the header right away and the body chunk by chunk, whatever its size or transfer encoding.
+    // The request is sent with "Connection: close", so the response ends where the upstream connection does
+    // and it does not have to be parsed at all. All data goes through one fixed buffer; once it is full, the
+    // upstream socket is not read until the client took some, which keeps the memory per request bounded
+    // and lets TCP slow down the upstream server to the pace of the client. The channel gets control back,
+    // through CHANNEL::Streamed(), once the upstream connection closed and everything was passed on.
+    template <typename CHANNEL>
+    class ProxyStreamType {
+    private:
+        static constexpr uint32_t BufferSize = 64 * 1024;
+
+        enum state : uint8_t {
+            IDLE,
+            CONNECTING,
+            REQUESTING,
+            RELAYING,
+            DRAINING
+        };
+
+        class Side : public Core::IResource {
+        public:
+            Side() = delete;
+            Side(const Side&) = delete;
+            Side& operator=(const Side&) = delete;
+
+            Side(ProxyStreamType& parent, const bool upstream)
+                : _parent(parent)
+                , _upstream(upstream)
+                , _descriptor(-1)
+            {
+            }
+            ~Side() override
+            {
+                Close();
+            }
+
+        public:
+            Core::IResource::handle Descriptor() const override
+            {
+                return (_descriptor);
+            }
+            inline void Open(const int descriptor)
+            {
+                _descriptor = descriptor;
+                Core::ResourceMonitor::Instance().Register(*this);
+            }
+            void Close()
+            {
+                if (_descriptor != -1) {
+                    Core::ResourceMonitor::Instance().Unregister(*this);
+#ifndef __WIN32__
+                    ::close(_descriptor);
+#endif
+                    _descriptor = -1;
+                }
+            }
+
+        private:
+            uint16_t Events() override
+            {
+                return (_parent.Interest(_upstream));
+            }
+            void Handle(const uint16_t events) override
+            {
+                _parent.Handle(_upstream, events);
+            }
+
+        private:
+            ProxyStreamType& _parent;
+            const bool _upstream;
+            int _descriptor;
+        };
+
+    public:
+        ProxyStreamType() = delete;
+        ProxyStreamType(const ProxyStreamType&) = delete;
+        ProxyStreamType& operator=(const ProxyStreamType&) = delete;
+
+        ProxyStreamType(CHANNEL& parent)
+            : _parent(parent)
+            , _state(IDLE)
+            , _upstream(*this, true)
+            , _downstream(*this, false)
+            , _request()
+            , _buffer()
+            , _begin(0)
+            , _end(0)
+            , _status(0)
+            , _relayed(0)
+            , _firstByte(0)
+            , _progressed(false)
+        {
+        }
+        ~ProxyStreamType()
+        {
+            Abort();
+        }
+
+    public:
+        inline bool IsActive() const
+        {
+            return (_state != IDLE);
+        }
+        // What came from the upstream server for the last request, it stays available once it is done.
+        inline uint16_t Status() const
+        {
+            return (_status);
+        }
+        inline uint64_t Relayed() const
+        {
+            return (_relayed);
+        }
+        inline uint64_t FirstByte() const
+        {
+            return (_firstByte);
+        }
+        // Did anything come in or go out since the previous call? The channel counts it as activity on its link.
+        inline bool Progressed()
+        {
+            return (_progressed.exchange(false));
+        }
+        // The request must be complete, "Connection: close" included. Returns false, leaving the socket of the
+        // channel alone, if no connection to the upstream server could be started.
+        bool Start(const Core::IResource::handle socket, const Core::NodeId& remote, const string& request)
+        {
+            ASSERT(IsActive() == false);
+#ifndef __WIN32__
+            struct addrinfo hints;
+            struct addrinfo* address = nullptr;
+
+            ::memset(&hints, 0, sizeof(hints));
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV;
+
+            if (::getaddrinfo(remote.HostAddress().c_str(), Core::NumberType<uint16_t>(remote.PortNumber()).Text().c_str(), &hints, &address) == 0) {
+                int upstream = ::socket(address->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+                if ((upstream != -1) && (::connect(upstream, address->ai_addr, address->ai_addrlen) == -1) && (errno != EINPROGRESS)) {
+                    ::close(upstream);
+                    upstream = -1;
+                }
+
+                if (upstream != -1) {
+                    int downstream = ::fcntl(socket, F_DUPFD_CLOEXEC, 0);
+
+                    if (downstream == -1) {
+                        ::close(upstream);
+                    } else {
+                        _buffer.resize(BufferSize);
+                        _request = request;
+                        _begin = 0;
+                        _end = 0;
+                        _status = 0;
+                        _relayed = 0;
+                        _firstByte = 0;
+                        _state = CONNECTING;
+
+                        _upstream.Open(upstream);
+                        _downstream.Open(downstream);
+                    }
+                }
+
+                ::freeaddrinfo(address);
+            }
+#endif
+            return (IsActive());
+        }
+        // The channel is going down, stop without reporting back.
+        void Abort()
+        {
+            if (IsActive() == true) {
+                Release();
+            }
+        }
+
+    private:
+        uint16_t Interest(const bool upstream) const
+        {
+            uint16_t result = 0;
+
+            if (upstream == true) {
+                if ((_state == CONNECTING) || (_state == REQUESTING)) {
+                    result = POLLOUT;
+                } else if ((_state == RELAYING) && (_end < _buffer.size())) {
+                    result = POLLIN;
+                }
+            } else if (_end > _begin) {
+                result = POLLOUT;
+            }
+
+            return (result);
+        }
+        void Handle(const bool upstream, const uint16_t events)
+        {
+#ifndef __WIN32__
+            bool failed = false;
+
+            if (upstream == true) {
+                failed = Upstream(events);
+            } else if ((events & (POLLERR | POLLHUP)) != 0) {
+                failed = true;
+            } else {
+                bool blocked = false;
+
+                while ((failed == false) && (blocked == false) && (_end > _begin)) {
+                    ssize_t sent = ::send(_downstream.Descriptor(), &(_buffer[_begin]), _end - _begin, MSG_NOSIGNAL);
+
+                    if (sent > 0) {
+                        _begin += static_cast<uint32_t>(sent);
+                        _progressed = true;
+                    } else {
+                        blocked = ((sent == -1) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)));
+                        failed = !blocked;
+                    }
+                }
+
+                if (_begin == _end) {
+                    _begin = 0;
+                    _end = 0;
+                }
+            }
+
+            if ((failed == true) || ((_state == DRAINING) && (_end == _begin))) {
+                Release();
+
+                _parent.Streamed(failed == false);
+            } else {
+                // The other side may have something to do now.
+                Core::ResourceMonitor::Instance().Break();
+            }
+#endif
+        }
+        bool Upstream(const uint16_t events)
+        {
+            bool failed = false;
+#ifndef __WIN32__
+            if (_state == CONNECTING) {
+                int error = 0;
+                socklen_t length = sizeof(error);
+
+                if ((::getsockopt(_upstream.Descriptor(), SOL_SOCKET, SO_ERROR, &error, &length) == 0) && (error == 0)) {
+                    _state = REQUESTING;
+                } else {
+                    // Nothing went to the client yet, so it can still get a proper answer.
+                    Reply(_T("HTTP/1.1 502 Bad Gateway\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"));
+                }
+            }
+
+            if (_state == REQUESTING) {
+                ssize_t sent = ::send(_upstream.Descriptor(), _request.c_str(), _request.length(), MSG_NOSIGNAL);
+
+                if (sent > 0) {
+                    _request.erase(0, static_cast<size_t>(sent));
+
+                    if (_request.empty() == true) {
+                        _state = RELAYING;
+                    }
+                } else if ((sent == -1) && (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                    Reply(_T("HTTP/1.1 502 Bad Gateway\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"));
+                }
+            } else if ((_state == RELAYING) && ((events & (POLLIN | POLLHUP | POLLERR)) != 0)) {
+                if (_end == _buffer.size()) {
+                    // Make room at the end, by moving what is left to the front.
+                    ::memmove(&(_buffer[0]), &(_buffer[_begin]), _end - _begin);
+                    _end -= _begin;
+                    _begin = 0;
+                }
+
+                ssize_t length = ::recv(_upstream.Descriptor(), &(_buffer[_end]), _buffer.size() - _end, 0);
+
+                if (length > 0) {
+                    if (_relayed == 0) {
+                        Started(&(_buffer[_end]), static_cast<uint32_t>(length));
+                    }
+
+                    _end += static_cast<uint32_t>(length);
+                    _relayed += static_cast<uint64_t>(length);
+                    _progressed = true;
+                } else if (length == 0) {
+                    // The response is complete, now the client has to get the rest.
+                    _state = DRAINING;
+                    _upstream.Close();
+                } else if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                    failed = true;
+                }
+            }
+#endif
+            return (failed);
+        }
+        // The status line is in the first bytes of the response, it is not parsed any further than that.
+        void Started(const uint8_t data[], const uint32_t length)
+        {
+            const string line(reinterpret_cast<const char*>(data), std::min(length, static_cast<uint32_t>(16)));
+
+            _firstByte = Core::Time::Now().Ticks();
+
+            if ((line.compare(0, 5, _T("HTTP/")) == 0) && (line.find(' ') != string::npos)) {
+                _status = static_cast<uint16_t>(::atoi(line.c_str() + line.find(' ') + 1));
+            }
+        }
+        void Reply(const TCHAR response[])
+        {
+            const uint32_t length = static_cast<uint32_t>(::strlen(response));
+
+            Started(reinterpret_cast<const uint8_t*>(response), length);
+
+            ::memcpy(&(_buffer[0]), response, length);
+            _begin = 0;
+            _end = length;
+            _state = DRAINING;
+            _upstream.Close();
+        }
+        void Release()
+        {
+            _upstream.Close();
+            _downstream.Close();
+            _request.clear();
+            _buffer.clear();
+            _buffer.shrink_to_fit();
+            _state = IDLE;
+        }
+
+    private:
+        CHANNEL& _parent;
+        state _state;
+        Side _upstream;
+        Side _downstream;
+        string _request;
+        std::vector<uint8_t> _buffer;
+        uint32_t _begin;
+        uint32_t _end;
+        uint16_t _status;
+        uint64_t _relayed;
+        uint64_t _firstByte;
+        std::atomic<bool> _progressed;
+    };
+}
+}
+
+#endif // __WEBSERVER_PROXYSTREAM_H
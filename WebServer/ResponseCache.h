@@ -0,0 +1,345 @@
+#ifndef __WEBSERVER_RESPONSECACHE_H
+#define __WEBSERVER_RESPONSECACHE_H
+
+#include "Module.h"
+#include "Fields.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // A shared cache for responses of proxied GET requests, as described by RFC 7234. Only complete 200
+    // responses are kept, for as long as their Cache-Control allows (s-maxage or max-age); no-store and
+    // private responses are never kept, no-cache ones always have to be revalidated. A stale response with an
+    // ETag is revalidated with the upstream server, a 304 makes it fresh again. Responses that vary on more
+    // than Accept-Encoding, which is part of the key, are not kept. Requests with credentials (a token or a
+    // cookie) only get, and only leave, responses meant for everyone: public or with an s-maxage. The least
+    // recently used responses are dropped once the configured capacity is exceeded.
+    class ResponseCache {
+    public:
+        enum state : uint8_t {
+            MISS,
+            FRESH,
+            STALE
+        };
+
+        struct Entry {
+            Web::Response Header; // Only the end-to-end fields are kept, and replayed
+            string ETag;
+            string Body;
+            uint64_t Expires;
+            bool Shared; // May be given to requests with credentials
+        };
+
+    private:
+        ResponseCache(const ResponseCache&) = delete;
+        ResponseCache& operator=(const ResponseCache&) = delete;
+
+        struct Element {
+            string Key;
+            std::shared_ptr<const Entry> Content;
+        };
+
+        typedef std::list<Element> Elements;
+
+    public:
+        ResponseCache()
+            : _adminLock()
+            , _elements()
+            , _index()
+            , _size(0)
+            , _capacity(0)
+            , _hits(0)
+            , _misses(0)
+            , _revalidations(0)
+        {
+        }
+        ~ResponseCache()
+        {
+        }
+
+    public:
+        // Capacity in bytes, 0 disables the cache.
+        void Configure(const uint32_t capacity)
+        {
+            _adminLock.Lock();
+
+            _capacity = capacity;
+            Evict();
+
+            _adminLock.Unlock();
+        }
+        inline bool IsEnabled() const
+        {
+            return (_capacity != 0);
+        }
+        inline uint32_t Hits() const
+        {
+            return (_hits);
+        }
+        inline uint32_t Misses() const
+        {
+            return (_misses);
+        }
+        inline uint32_t Revalidations() const
+        {
+            return (_revalidations);
+        }
+        inline uint32_t Size() const
+        {
+            return (_size);
+        }
+
+        // Empty if the request can not be served from the cache.
+        static string Key(const Web::Request& request)
+        {
+            string result;
+
+            if (request.Verb == Web::Request::HTTP_GET) {
+                result = request.Path;
+
+                if (request.Query.IsSet() == true) {
+                    result += '?';
+                    result += request.Query.Value();
+                }
+
+                result += '\n';
+
+                string encodings;
+
+                if (Fields::AcceptEncoding(request, encodings) == true) {
+                    result += encodings;
+                }
+            }
+
+            return (result);
+        }
+        // Requests with credentials do not get what is kept for everyone, unless it says it is for them too.
+        static bool Credentials(const Web::Request& request)
+        {
+            string cookie;
+
+            return ((request.WebToken.IsSet() == true) || (Fields::Cookie(request, cookie) == true));
+        }
+        // On a hit, the entry is returned. It may be stale, then it should be revalidated first.
+        state Lookup(const string& key, const bool credentials, std::shared_ptr<const Entry>& entry)
+        {
+            state result = MISS;
+
+            _adminLock.Lock();
+
+            std::map<string, Elements::iterator>::iterator index(_index.find(key));
+
+            if ((index != _index.end()) && ((credentials == false) || (index->second->Content->Shared == true))) {
+                _elements.splice(_elements.begin(), _elements, index->second);
+                entry = index->second->Content;
+
+                result = (entry->Expires > Core::Time::Now().Ticks() ? FRESH : (entry->ETag.empty() == false ? STALE : MISS));
+
+                if (result == MISS) {
+                    // Expired, and nothing to revalidate it with.
+                    Remove(index);
+                    entry.reset();
+                }
+            }
+
+            if (result == FRESH) {
+                _hits++;
+            } else if (result == MISS) {
+                _misses++;
+            } else {
+                _revalidations++;
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
+        // Keeps the response, if it may be kept. Anything we had for the key is gone, unless the response is
+        // one for the credentials of the request only: it says nothing about what everyone else gets.
+        void Store(const string& key, const bool credentials, const Web::Response& response)
+        {
+            uint64_t expires = 0;
+            const bool shared = IsPublic(response);
+
+            if ((credentials == false) || (shared == true)) {
+                _adminLock.Lock();
+
+                std::map<string, Elements::iterator>::iterator index(_index.find(key));
+
+                if (index != _index.end()) {
+                    Remove(index);
+                }
+
+                if ((_capacity != 0) && (response.ErrorCode == Web::STATUS_OK) && (IsShared(response) == true) && (Freshness(response, expires) == true)) {
+                    std::shared_ptr<Entry> entry(std::make_shared<Entry>());
+
+                    Fields::EndToEnd(response, entry->Header);
+                    Fields::ETag(response, entry->ETag);
+                    entry->Expires = expires;
+                    entry->Shared = shared;
+
+                    if (response.HasBody() == true) {
+                        entry->Body = *(response.Body<Web::TextBody>());
+                    }
+
+                    if ((entry->Expires > Core::Time::Now().Ticks()) || (entry->ETag.empty() == false)) {
+                        Element element;
+
+                        element.Key = key;
+                        element.Content = entry;
+
+                        _size += Cost(element);
+                        _elements.push_front(element);
+                        _index.insert(std::pair<string, Elements::iterator>(key, _elements.begin()));
+
+                        Evict();
+                    }
+                }
+
+                _adminLock.Unlock();
+            }
+        }
+        // The upstream server confirmed (304) the entry we had, it is fresh again for as long as it says now.
+        void Refresh(const string& key, const std::shared_ptr<const Entry>& entry, const Web::Response& response)
+        {
+            uint64_t expires = 0;
+
+            _adminLock.Lock();
+
+            std::map<string, Elements::iterator>::iterator index(_index.find(key));
+
+            if ((index != _index.end()) && (index->second->Content == entry)) {
+                if (Freshness(response, expires) == true) {
+                    std::shared_ptr<Entry> refreshed(std::make_shared<Entry>());
+
+                    // What the 304 says about the response replaces what we had (RFC 7234, section 4.3.4).
+                    Fields::EndToEnd(entry->Header, refreshed->Header);
+                    Fields::EndToEnd(response, refreshed->Header);
+                    refreshed->ETag = entry->ETag;
+                    refreshed->Body = entry->Body;
+                    refreshed->Expires = expires;
+                    refreshed->Shared = (entry->Shared == true) || (IsPublic(response) == true);
+
+                    _size -= Cost(*(index->second));
+                    index->second->Content = refreshed;
+                    _size += Cost(*(index->second));
+                } else {
+                    Remove(index);
+                }
+            }
+
+            _adminLock.Unlock();
+        }
+        // Fills a response to a client from the entry.
+        static void Answer(const Entry& entry, Web::Response& response)
+        {
+            Fields::EndToEnd(entry.Header, response);
+        }
+
+    private:
+        static bool Directive(const string& cacheControl, const TCHAR name[], uint64_t* value)
+        {
+            bool result = false;
+            const size_t length = ::strlen(name);
+            size_t position = 0;
+
+            while ((result == false) && ((position = cacheControl.find(name, position)) != string::npos)) {
+                const bool start = ((position == 0) || (cacheControl[position - 1] == ' ') || (cacheControl[position - 1] == ','));
+                const TCHAR next = (position + length < cacheControl.length() ? cacheControl[position + length] : ',');
+
+                if ((start == true) && ((next == ',') || (next == ' ') || (next == '='))) {
+                    result = true;
+
+                    if (value != nullptr) {
+                        *value = ((next == '=') ? ::strtoull(cacheControl.c_str() + position + length + 1, nullptr, 10) : 0);
+                    }
+                }
+
+                position += length;
+            }
+
+            return (result);
+        }
+        static bool IsShared(const Web::Response& response)
+        {
+            string cacheControl;
+            string vary;
+
+            Fields::CacheControl(response, cacheControl);
+            cacheControl = Lowered(cacheControl);
+
+            return ((Directive(cacheControl, _T("no-store"), nullptr) == false) && (Directive(cacheControl, _T("private"), nullptr) == false) && ((Fields::Vary(response, vary) == false) || (Lowered(vary) == _T("accept-encoding"))));
+        }
+        // Meant for everyone, also for requests with credentials (RFC 7234, section 3.2).
+        static bool IsPublic(const Web::Response& response)
+        {
+            string cacheControl;
+
+            Fields::CacheControl(response, cacheControl);
+            cacheControl = Lowered(cacheControl);
+
+            return ((Directive(cacheControl, _T("public"), nullptr) == true) || (Directive(cacheControl, _T("s-maxage"), nullptr) == true));
+        }
+        // Returns false if the response says nothing about how long it stays fresh.
+        static bool Freshness(const Web::Response& response, uint64_t& expires)
+        {
+            bool result = false;
+            uint64_t seconds = 0;
+            string cacheControl;
+
+            Fields::CacheControl(response, cacheControl);
+            cacheControl = Lowered(cacheControl);
+
+            if (Directive(cacheControl, _T("no-cache"), nullptr) == true) {
+                expires = 0;
+                result = true;
+            } else if ((Directive(cacheControl, _T("s-maxage"), &seconds) == true) || (Directive(cacheControl, _T("max-age"), &seconds) == true)) {
+                expires = Core::Time::Now().Ticks() + (seconds * 1000 * 1000);
+                result = true;
+            }
+
+            return (result);
+        }
+        static string Lowered(const string& text)
+        {
+            string result(text);
+
+            std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+
+            return (result);
+        }
+        static uint32_t Cost(const Element& element)
+        {
+            return (static_cast<uint32_t>(sizeof(Entry) + element.Key.length() + element.Content->Body.length() + element.Content->ETag.length()));
+        }
+        void Remove(std::map<string, Elements::iterator>::iterator& index)
+        {
+            _size -= Cost(*(index->second));
+            _elements.erase(index->second);
+            index = _index.erase(index);
+        }
+        void Evict()
+        {
+            while ((_size > _capacity) && (_elements.empty() == false)) {
+                std::map<string, Elements::iterator>::iterator index(_index.find(_elements.back().Key));
+
+                ASSERT(index != _index.end());
+
+                Remove(index);
+            }
+        }
+
+    private:
+        Core::CriticalSection _adminLock;
+        Elements _elements;
+        std::map<string, Elements::iterator> _index;
+        uint32_t _size;
+        uint32_t _capacity;
+        uint32_t _hits;
+        uint32_t _misses;
+        uint32_t _revalidations;
+    };
+}
+}
+
+#endif // __WEBSERVER_RESPONSECACHE_H
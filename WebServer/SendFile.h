@@ -0,0 +1,190 @@
+#ifndef __WEBSERVER_SENDFILE_H
+#define __WEBSERVER_SENDFILE_H
+
+#include "Module.h"
+
+#include <atomic>
+
+#ifndef __WIN32__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Sends a response straight from a file to the socket of a channel with sendfile(2), so the content is
+    // never copied to user space. The channel hands over the response as segments: some text (the header,
+    // or a part header of a multipart response) followed by a part of the file. From then on this object
+    // owns the socket for writing, until it reports back to the channel through CHANNEL::Transferred().
+    // The socket is written through a duplicate of its descriptor, driven by the same resource monitor
+    // thread as the channel itself.
+    template <typename CHANNEL>
+    class SendFileType : public Core::IResource {
+    public:
+        struct Segment {
+            string Text;
+            uint64_t Offset;
+            uint64_t Length;
+        };
+
+    public:
+        SendFileType() = delete;
+        SendFileType(const SendFileType&) = delete;
+        SendFileType& operator=(const SendFileType&) = delete;
+
+        SendFileType(CHANNEL& parent)
+            : _parent(parent)
+            , _socket(-1)
+            , _file(-1)
+            , _segments()
+            , _offset(0)
+            , _progressed(false)
+        {
+        }
+        ~SendFileType() override
+        {
+            Abort();
+        }
+
+    public:
+        inline bool IsActive() const
+        {
+            return (_socket != -1);
+        }
+        // Did anything go out since the previous call? The channel counts it as activity on its link.
+        inline bool Progressed()
+        {
+            return (_progressed.exchange(false));
+        }
+        // Size and modification time (in ticks) of a regular file, false if it is not one (or it is not there).
+        static bool Stat(const string& fileName, uint64_t& size, uint64_t& modified)
+        {
+            bool result = false;
+#ifndef __WIN32__
+            struct stat info;
+
+            if ((::stat(fileName.c_str(), &info) == 0) && (S_ISREG(info.st_mode))) {
+                size = static_cast<uint64_t>(info.st_size);
+                modified = (static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000 * 1000) + (info.st_mtim.tv_nsec / 1000);
+                result = true;
+            }
+#endif
+            return (result);
+        }
+        // Send the segments, which are taken over. Returns false, leaving the socket and the segments alone,
+        // if the file or the socket can not be used.
+        bool Start(const Core::IResource::handle socket, const string& fileName, std::list<Segment>& segments)
+        {
+            ASSERT(IsActive() == false);
+            ASSERT(segments.empty() == false);
+#ifndef __WIN32__
+            _file = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+
+            if (_file != -1) {
+                _socket = ::fcntl(socket, F_DUPFD_CLOEXEC, 0);
+
+                if (_socket == -1) {
+                    ::close(_file);
+                    _file = -1;
+                } else {
+                    _segments.swap(segments);
+                    _offset = static_cast<off_t>(_segments.front().Offset);
+
+                    Core::ResourceMonitor::Instance().Register(*this);
+                }
+            }
+#endif
+            return (IsActive());
+        }
+        // The channel is going down, stop without reporting back.
+        void Abort()
+        {
+            if (IsActive() == true) {
+                Core::ResourceMonitor::Instance().Unregister(*this);
+                Release();
+            }
+        }
+
+    private:
+        Core::IResource::handle Descriptor() const override
+        {
+            return (_socket);
+        }
+        uint16_t Events() override
+        {
+            return (IsActive() == true ? POLLOUT : 0);
+        }
+        void Handle(const uint16_t events) override
+        {
+#ifndef __WIN32__
+            bool failed = ((events & (POLLERR | POLLHUP)) != 0);
+            bool blocked = false;
+
+            while ((failed == false) && (blocked == false) && (_segments.empty() == false)) {
+                Segment& segment(_segments.front());
+                ssize_t sent;
+
+                if (segment.Text.empty() == false) {
+                    sent = ::send(_socket, segment.Text.c_str(), segment.Text.length(), MSG_NOSIGNAL);
+
+                    if (sent > 0) {
+                        segment.Text.erase(0, static_cast<size_t>(sent));
+                    }
+                } else if (segment.Length > 0) {
+                    // Moves at most 2GB at once, the offset is updated by the kernel.
+                    sent = ::sendfile(_socket, _file, &_offset, static_cast<size_t>(std::min(segment.Length, static_cast<uint64_t>(0x7FFFF000))));
+
+                    if (sent > 0) {
+                        segment.Length -= static_cast<uint64_t>(sent);
+                    }
+                } else {
+                    _segments.pop_front();
+                    _offset = (_segments.empty() == true ? 0 : static_cast<off_t>(_segments.front().Offset));
+                    sent = 1;
+                }
+
+                if (sent > 0) {
+                    _progressed = true;
+                } else {
+                    // 0 means the file got shorter than announced, the response can not be completed.
+                    blocked = ((sent == -1) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)));
+                    failed = !blocked;
+                }
+            }
+
+            if ((failed == true) || (blocked == false)) {
+                Core::ResourceMonitor::Instance().Unregister(*this);
+                Release();
+
+                _parent.Transferred(failed == false);
+            }
+#endif
+        }
+        void Release()
+        {
+#ifndef __WIN32__
+            ::close(_socket);
+            ::close(_file);
+#endif
+            _socket = -1;
+            _file = -1;
+            _segments.clear();
+        }
+
+    private:
+        CHANNEL& _parent;
+        int _socket;
+        int _file;
+        std::list<Segment> _segments;
+        off_t _offset;
+        std::atomic<bool> _progressed;
+    };
+}
+}
+
+#endif // __WEBSERVER_SENDFILE_H
@@ -0,0 +1,178 @@
+// Compares sending a file over a loopback TCP connection with sendfile(2), the way the WebServer sends
+// large files (see SendFile.h), with reading it in chunks and sending those, the way the framework sends
+// a file body. Reports the throughput and the CPU time spent by the sending thread for both.
+//
+// Usage: SendFileBenchmark [size in MB (256)] [rounds (4)] [chunk in KB (16)]
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+enum method {
+    SENDFILE,
+    READ_SEND
+};
+
+// CPU time (user + system) of the calling thread, in microseconds.
+static uint64_t ThreadTime()
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_THREAD, &usage);
+
+    return ((static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 * 1000) + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+static uint64_t Now()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((static_cast<uint64_t>(now.tv_sec) * 1000 * 1000) + (now.tv_nsec / 1000));
+}
+
+static bool Send(const int socket, const int file, const uint64_t size, const method how, std::vector<char>& buffer)
+{
+    uint64_t offset = 0;
+    bool result = true;
+
+    while ((result == true) && (offset < size)) {
+        if (how == SENDFILE) {
+            off_t position = static_cast<off_t>(offset);
+            ssize_t sent = sendfile(socket, file, &position, static_cast<size_t>(size - offset));
+
+            result = (sent > 0);
+            offset = static_cast<uint64_t>(position);
+        } else {
+            ssize_t loaded = pread(file, buffer.data(), buffer.size(), static_cast<off_t>(offset));
+            ssize_t written = 0;
+
+            result = (loaded > 0);
+
+            while ((result == true) && (written < loaded)) {
+                ssize_t sent = send(socket, &(buffer[written]), loaded - written, 0);
+
+                result = (sent > 0);
+                written += (result == true ? sent : 0);
+            }
+
+            offset += (result == true ? loaded : 0);
+        }
+    }
+
+    return (result);
+}
+
+static bool Run(const int file, const uint64_t size, const uint32_t rounds, const method how, const uint32_t chunk)
+{
+    int listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if ((listener == -1) || (bind(listener, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) || (getsockname(listener, reinterpret_cast<struct sockaddr*>(&address), &length) != 0) || (listen(listener, 1) != 0)) {
+        fprintf(stderr, "Could not listen on the loopback interface\n");
+        return (false);
+    }
+
+    uint64_t received = 0;
+
+    // The receiving end only drains the connection, as a client would.
+    std::thread receiver([&address, &received]() {
+        int client = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+        if ((client != -1) && (connect(client, reinterpret_cast<const struct sockaddr*>(&address), sizeof(address)) == 0)) {
+            char buffer[64 * 1024];
+            ssize_t length;
+
+            while ((length = read(client, buffer, sizeof(buffer))) > 0) {
+                received += length;
+            }
+        }
+        if (client != -1) {
+            close(client);
+        }
+    });
+
+    int connection = accept(listener, nullptr, nullptr);
+    std::vector<char> buffer(chunk);
+    bool result = (connection != -1);
+    const uint64_t cpu = ThreadTime();
+    const uint64_t start = Now();
+
+    for (uint32_t round = 0; (result == true) && (round < rounds); round++) {
+        result = Send(connection, file, size, how, buffer);
+    }
+
+    const uint64_t elapsed = Now() - start;
+    const uint64_t spent = ThreadTime() - cpu;
+
+    if (connection != -1) {
+        close(connection);
+    }
+    receiver.join();
+    close(listener);
+
+    if (result == true) {
+        const double megabytes = static_cast<double>(size * rounds) / (1024 * 1024);
+
+        printf("%-10s %8.0f MB/s %8.3f s CPU %8.2f ms CPU per 100 MB\n",
+            (how == SENDFILE ? "sendfile" : "read+send"),
+            (megabytes * 1000 * 1000) / static_cast<double>(elapsed > 0 ? elapsed : 1),
+            static_cast<double>(spent) / (1000 * 1000),
+            (static_cast<double>(spent) / 1000) * (100 / megabytes));
+    } else {
+        fprintf(stderr, "Sending failed: %s, %llu bytes received\n", strerror(errno), static_cast<unsigned long long>(received));
+    }
+
+    return (result);
+}
+
+int main(int argc, char* argv[])
+{
+    const uint64_t size = static_cast<uint64_t>(argc > 1 ? atoi(argv[1]) : 256) * 1024 * 1024;
+    const uint32_t rounds = (argc > 2 ? atoi(argv[2]) : 4);
+    const uint32_t chunk = (argc > 3 ? atoi(argv[3]) : 16) * 1024;
+    char fileName[] = "/tmp/SendFileBenchmark.XXXXXX";
+    int file = mkstemp(fileName);
+
+    if ((file == -1) || (size == 0) || (rounds == 0) || (chunk == 0)) {
+        fprintf(stderr, "Usage: %s [size in MB (256)] [rounds (4)] [chunk in KB (16)]\n", argv[0]);
+        return (1);
+    }
+
+    unlink(fileName);
+
+    // Written for real, so the file is in the page cache and both methods read the same memory.
+    std::vector<char> content(1024 * 1024, 'x');
+    uint64_t written = 0;
+
+    while ((written < size) && (write(file, content.data(), content.size()) == static_cast<ssize_t>(content.size()))) {
+        written += content.size();
+    }
+
+    printf("%llu MB, %u rounds, read+send in chunks of %u KB\n", static_cast<unsigned long long>(size / (1024 * 1024)), rounds, chunk / 1024);
+
+    bool result = ((written >= size) && (Run(file, size, rounds, SENDFILE, chunk) == true) && (Run(file, size, rounds, READ_SEND, chunk) == true));
+
+    close(file);
+
+    return (result == true ? 0 : 1);
+}
@@ -26,6 +26,9 @@ namespace Plugin {
         _service = service;
         _skipURL = static_cast<uint32_t>(_service->WebPrefix().length());
 
+        // The implementation writes its report here, the "statistics" configuration says how often.
+        _statistics = _service->VolatilePath() + _service->Callsign() + _T("-statistics.json");
+
         config.FromString(_service->ConfigLine());
 
         // Register the Process::Notification stuff. The Remote process might die before we get a
@@ -123,6 +126,44 @@ namespace Plugin {
         return (string());
     }
 
+    /* virtual */ void WebServer::Inbound(Web::Request& /* request */)
+    {
+    }
+
+    // <GET> ../Statistics		Get the latest report of the requests served: per route counters and latencies, proxy cache and access log figures.
+    //				The report is written every "statistics" seconds (10 by default), with "statistics" set to 0 there is none: 404.
+    /* virtual */ Core::ProxyType<Web::Response> WebServer::Process(const Web::Request& request)
+    {
+        ASSERT(_skipURL <= request.Path.length());
+
+        Core::ProxyType<Web::Response> result(PluginHost::Factories::Instance().Response());
+        Core::TextSegmentIterator index(Core::TextFragment(request.Path, _skipURL, static_cast<uint32_t>(request.Path.length() - _skipURL)), false, '/');
+
+        // If there is an entry, the first one will alwys be a '/', skip this one..
+        index.Next();
+
+        if ((request.Verb == Web::Request::HTTP_GET) && (index.Remainder() == _T("Statistics"))) {
+            if (Core::File(_statistics).Exists() == true) {
+                Core::ProxyType<Web::FileBody> fileBody(PluginHost::Factories::Instance().FileBody());
+
+                *fileBody = _statistics;
+
+                result->ErrorCode = Web::STATUS_OK;
+                result->Message = _T("OK");
+                result->ContentType = Web::MIME_JSON;
+                result->Body<Web::FileBody>(fileBody);
+            } else {
+                result->ErrorCode = Web::STATUS_NOT_FOUND;
+                result->Message = _T("No statistics reported (yet)");
+            }
+        } else {
+            result->ErrorCode = Web::STATUS_BAD_REQUEST;
+            result->Message = _T("Unsupported request for the [WebServer] service.");
+        }
+
+        return (result);
+    }
+
     void WebServer::Deactivated(RPC::IRemoteConnection* connection)
     {
         // This can potentially be called on a socket thread, so the deactivation (wich in turn kills this object) must be done
@@ -8,7 +8,7 @@
 namespace WPEFramework {
 namespace Plugin {
 
-    class WebServer : public PluginHost::IPlugin {
+    class WebServer : public PluginHost::IPlugin, public PluginHost::IWeb {
     private:
         WebServer(const WebServer&) = delete;
         WebServer& operator=(const WebServer&) = delete;
@@ -86,6 +86,7 @@ namespace Plugin {
 
         BEGIN_INTERFACE_MAP(WebServer)
         INTERFACE_ENTRY(IPlugin)
+        INTERFACE_ENTRY(PluginHost::IWeb)
         INTERFACE_AGGREGATE(Exchange::IMemory, _memory)
         INTERFACE_AGGREGATE(Exchange::IWebServer, _server)
         INTERFACE_AGGREGATE(PluginHost::IStateControl, _server)
@@ -112,12 +113,25 @@ namespace Plugin {
         // to this plugin. This Metadata can be used by the MetData plugin to publish this information to the ouside world.
         virtual string Information() const;
 
+        //  IWeb methods
+        // -------------------------------------------------------------------------------------------------------
+        // Whenever a request is received, it might carry some additional data in the body. This method allows
+        // the plugin to attach a deserializable data object (ref counted) to be loaded with any potential found
+        // in the body of the request.
+        virtual void Inbound(Web::Request& request);
+
+        // If everything is received correctly, the request is passed on to us, through a thread from the thread pool, to
+        // do our thing and to return the result in the response object. Here the actual specific module work,
+        // based on a a request is handled.
+        virtual Core::ProxyType<Web::Response> Process(const Web::Request& request);
+
     private:
         void Deactivated(RPC::IRemoteConnection* connection);
 
     private:
         uint32_t _skipURL;
         uint32_t _connectionId;
+        string _statistics;
         PluginHost::IShell* _service;
         Exchange::IWebServer* _server;
         Exchange::IMemory* _memory;
@@ -1,4 +1,13 @@
 #include "Module.h"
+#include "AccessLog.h"
+#include "AssetCache.h"
+#include "ByteRanges.h"
+#include "Fields.h"
+#include "Metrics.h"
+#include "PathTrie.h"
+#include "ProxyStream.h"
+#include "ResponseCache.h"
+#include "SendFile.h"
 #include <interfaces/IMemory.h>
 #include <interfaces/IWebServer.h>
 
@@ -7,6 +16,44 @@ namespace Plugin {
 
     static Core::ProxyPoolType<Web::TextBody> _textBodies(5);
 
+    // Precompressed variants that can live next to a file, in order of preference.
+    static const struct {
+        const TCHAR* Extension;
+        const TCHAR* Encoding;
+    } _variants[] = {
+        { _T(".br"), _T("br") },
+        { _T(".gz"), _T("gzip") }
+    };
+
+    // The freshness of proxied responses comes from Cache-Control, every framework release has it.
+    static_assert(Fields::HasCacheControl<Web::Response>() == true, "The response cache needs Cache-Control");
+
+    // The features the framework this is built against has no header fields for, they are not offered.
+    static string Unsupported()
+    {
+        const struct {
+            const bool Supported;
+            const TCHAR* Feature;
+        } features[] = {
+            { (Fields::HasAcceptEncoding<Web::Request>() && Fields::HasContentEncoding<Web::Response>() && Fields::HasVary<Web::Response>()), _T("precompressed variants (Accept-Encoding, Content-Encoding, Vary)") },
+            { (Fields::HasIfNoneMatch<Web::Request>() && Fields::HasETag<Web::Response>()), _T("entity tags (If-None-Match, ETag)") },
+            { (Fields::HasIfModifiedSince<Web::Request>() && Fields::HasModified<Web::Response>()), _T("modification dates (If-Modified-Since, Last-Modified)") },
+            { Fields::HasRange<Web::Request>(), _T("byte ranges (Range)") },
+            { Fields::HasIfRange<Web::Request>(), _T("conditional byte ranges (If-Range)") },
+            { Fields::HasCookie<Web::Request>(), _T("keeping requests with cookies out of the response cache (Cookie)") }
+        };
+        string result;
+
+        for (uint8_t index = 0; index < (sizeof(features) / sizeof(features[0])); index++) {
+            if (features[index].Supported == false) {
+                result += (result.empty() == true ? _T("") : _T(", "));
+                result += features[index].Feature;
+            }
+        }
+
+        return (result);
+    }
+
     class WebServerImplementation : public Exchange::IWebServer, public PluginHost::IStateControl {
     private:
         enum enumState {
@@ -82,20 +129,32 @@ namespace Plugin {
                     , Path()
                     , Subst()
                     , Server()
+                    , Connections(4)
+                    , Pending(64)
+                    , Stream(false)
                 {
                     Add(_T("path"), &Path);
                     Add(_T("subst"), &Subst);
                     Add(_T("server"), &Server);
+                    Add(_T("connections"), &Connections);
+                    Add(_T("pending"), &Pending);
+                    Add(_T("stream"), &Stream);
                 }
                 Proxy(const Proxy& copy)
                     : Core::JSON::Container()
                     , Path(copy.Path)
                     , Subst(copy.Subst)
                     , Server(copy.Server)
+                    , Connections(copy.Connections)
+                    , Pending(copy.Pending)
+                    , Stream(copy.Stream)
                 {
                     Add(_T("path"), &Path);
                     Add(_T("subst"), &Subst);
                     Add(_T("server"), &Server);
+                    Add(_T("connections"), &Connections);
+                    Add(_T("pending"), &Pending);
+                    Add(_T("stream"), &Stream);
                 }
                 virtual ~Proxy()
                 {
@@ -105,6 +164,31 @@ namespace Plugin {
                 Core::JSON::String Path;
                 Core::JSON::String Subst;
                 Core::JSON::String Server;
+                Core::JSON::DecUInt8 Connections; // Upstream connections at most
+                Core::JSON::DecUInt16 Pending; // Requests waiting for a response at most, beyond that is a 503
+                Core::JSON::Boolean Stream; // Pass responses on as they come in, on a connection per request
+            };
+            class Cache : public Core::JSON::Container {
+            private:
+                Cache(const Cache&) = delete;
+                Cache& operator=(const Cache&) = delete;
+
+            public:
+                Cache()
+                    : Core::JSON::Container()
+                    , Size(4096)
+                    , File(256)
+                {
+                    Add(_T("size"), &Size);
+                    Add(_T("file"), &File);
+                }
+                ~Cache()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Size; // Total size in KB, 0 disables the cache
+                Core::JSON::DecUInt32 File; // Largest file kept in the cache, in KB
             };
 
         public:
@@ -115,6 +199,12 @@ namespace Plugin {
                 , Interface()
                 , Path(_T("www"))
                 , IdleTime(180)
+                , Proxies()
+                , Assets()
+                , SendFile(1024)
+                , ProxyCache(1024)
+                , Statistics(10)
+                , AccessLog()
             {
                 Add(_T("port"), &Port);
                 Add(_T("binding"), &Binding);
@@ -122,6 +212,11 @@ namespace Plugin {
                 Add(_T("path"), &Path);
                 Add(_T("idletime"), &IdleTime);
                 Add(_T("proxies"), &Proxies);
+                Add(_T("cache"), &Assets);
+                Add(_T("sendfile"), &SendFile);
+                Add(_T("proxycache"), &ProxyCache);
+                Add(_T("statistics"), &Statistics);
+                Add(_T("accesslog"), &AccessLog);
             }
             ~Config()
             {
@@ -134,6 +229,280 @@ namespace Plugin {
             Core::JSON::String Path;
             Core::JSON::DecUInt16 IdleTime;
             Core::JSON::ArrayType<Proxy> Proxies;
+            Cache Assets;
+            Core::JSON::DecUInt32 SendFile; // Files of this size (KB) and up are sent with sendfile(), 0 disables it
+            Core::JSON::DecUInt32 ProxyCache; // Total size of proxied responses kept, in KB, 0 disables it
+            Core::JSON::DecUInt16 Statistics; // Seconds between the reports the plugin serves (10), 0 disables them
+            Core::JSON::String AccessLog; // File a JSON line is appended to for every request, empty disables it
+        };
+
+        // What the WebServer reports about itself, written to a file from which the plugin serves it.
+        class Report : public Core::JSON::Container {
+        private:
+            Report(const Report&) = delete;
+            Report& operator=(const Report&) = delete;
+
+        public:
+            class Histogram : public Core::JSON::Container {
+            private:
+                Histogram& operator=(const Histogram&) = delete;
+
+            public:
+                Histogram()
+                    : Core::JSON::Container()
+                    , Count()
+                    , Mean()
+                    , P50()
+                    , P90()
+                    , P99()
+                    , Maximum()
+                    , Buckets()
+                {
+                    Add(_T("count"), &Count);
+                    Add(_T("mean"), &Mean);
+                    Add(_T("p50"), &P50);
+                    Add(_T("p90"), &P90);
+                    Add(_T("p99"), &P99);
+                    Add(_T("max"), &Maximum);
+                    Add(_T("buckets"), &Buckets);
+                }
+                Histogram(const Histogram& copy)
+                    : Core::JSON::Container()
+                    , Count(copy.Count)
+                    , Mean(copy.Mean)
+                    , P50(copy.P50)
+                    , P90(copy.P90)
+                    , P99(copy.P99)
+                    , Maximum(copy.Maximum)
+                    , Buckets(copy.Buckets)
+                {
+                    Add(_T("count"), &Count);
+                    Add(_T("mean"), &Mean);
+                    Add(_T("p50"), &P50);
+                    Add(_T("p90"), &P90);
+                    Add(_T("p99"), &P99);
+                    Add(_T("max"), &Maximum);
+                    Add(_T("buckets"), &Buckets);
+                }
+                ~Histogram()
+                {
+                }
+
+            public:
+                void Set(const Metrics::Histogram& histogram)
+                {
+                    uint8_t used = Metrics::Buckets;
+
+                    Count = histogram.Count();
+                    Mean = histogram.Mean();
+                    P50 = histogram.Percentile(50);
+                    P90 = histogram.Percentile(90);
+                    P99 = histogram.Percentile(99);
+                    Maximum = histogram.Maximum();
+
+                    // Trailing empty buckets are left out, bucket n still counts the values below 2^n.
+                    while ((used > 0) && (histogram.Bucket(used - 1) == 0)) {
+                        used--;
+                    }
+
+                    for (uint8_t index = 0; index < used; index++) {
+                        Core::JSON::DecUInt32 bucket;
+
+                        bucket = histogram.Bucket(index);
+                        Buckets.Add(bucket);
+                    }
+                }
+
+            public:
+                Core::JSON::DecUInt32 Count;
+                Core::JSON::DecUInt64 Mean;
+                Core::JSON::DecUInt64 P50;
+                Core::JSON::DecUInt64 P90;
+                Core::JSON::DecUInt64 P99;
+                Core::JSON::DecUInt64 Maximum;
+                Core::JSON::ArrayType<Core::JSON::DecUInt32> Buckets;
+            };
+            class Route : public Core::JSON::Container {
+            private:
+                Route& operator=(const Route&) = delete;
+
+            public:
+                Route()
+                    : Core::JSON::Container()
+                    , Path()
+                    , Requests(0)
+                    , ClientErrors(0)
+                    , ServerErrors(0)
+                    , Bytes(0)
+                    , FirstByte()
+                    , Total()
+                    , Size()
+                    , Connections()
+                    , Pending()
+                    , HighWater()
+                    , Rejected()
+                {
+                    Add(_T("route"), &Path);
+                    Add(_T("requests"), &Requests);
+                    Add(_T("clienterrors"), &ClientErrors);
+                    Add(_T("servererrors"), &ServerErrors);
+                    Add(_T("bytes"), &Bytes);
+                    Add(_T("ttfb"), &FirstByte);
+                    Add(_T("total"), &Total);
+                    Add(_T("size"), &Size);
+                    Add(_T("connections"), &Connections);
+                    Add(_T("pending"), &Pending);
+                    Add(_T("highwater"), &HighWater);
+                    Add(_T("rejected"), &Rejected);
+                }
+                Route(const Route& copy)
+                    : Core::JSON::Container()
+                    , Path(copy.Path)
+                    , Requests(copy.Requests)
+                    , ClientErrors(copy.ClientErrors)
+                    , ServerErrors(copy.ServerErrors)
+                    , Bytes(copy.Bytes)
+                    , FirstByte(copy.FirstByte)
+                    , Total(copy.Total)
+                    , Size(copy.Size)
+                    , Connections(copy.Connections)
+                    , Pending(copy.Pending)
+                    , HighWater(copy.HighWater)
+                    , Rejected(copy.Rejected)
+                {
+                    Add(_T("route"), &Path);
+                    Add(_T("requests"), &Requests);
+                    Add(_T("clienterrors"), &ClientErrors);
+                    Add(_T("servererrors"), &ServerErrors);
+                    Add(_T("bytes"), &Bytes);
+                    Add(_T("ttfb"), &FirstByte);
+                    Add(_T("total"), &Total);
+                    Add(_T("size"), &Size);
+                    Add(_T("connections"), &Connections);
+                    Add(_T("pending"), &Pending);
+                    Add(_T("highwater"), &HighWater);
+                    Add(_T("rejected"), &Rejected);
+                }
+                ~Route()
+                {
+                }
+
+            public:
+                Core::JSON::String Path; // Of the proxy, empty for what the WebServer serves itself
+                Core::JSON::DecUInt32 Requests;
+                Core::JSON::DecUInt32 ClientErrors;
+                Core::JSON::DecUInt32 ServerErrors; // Responses that were cut short included
+                Core::JSON::DecUInt64 Bytes;
+                Histogram FirstByte; // Microseconds
+                Histogram Total; // Microseconds
+                Histogram Size; // Bytes
+                // Only for proxies
+                Core::JSON::DecUInt32 Connections;
+                Core::JSON::DecUInt32 Pending;
+                Core::JSON::DecUInt32 HighWater;
+                Core::JSON::DecUInt32 Rejected;
+            };
+            class Cache : public Core::JSON::Container {
+            private:
+                Cache(const Cache&) = delete;
+                Cache& operator=(const Cache&) = delete;
+
+            public:
+                Cache()
+                    : Core::JSON::Container()
+                    , Hits(0)
+                    , Misses(0)
+                    , Revalidations(0)
+                    , Size(0)
+                {
+                    Add(_T("hits"), &Hits);
+                    Add(_T("misses"), &Misses);
+                    Add(_T("revalidations"), &Revalidations);
+                    Add(_T("size"), &Size);
+                }
+                ~Cache()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Hits;
+                Core::JSON::DecUInt32 Misses;
+                Core::JSON::DecUInt32 Revalidations;
+                Core::JSON::DecUInt32 Size; // Bytes
+            };
+            class Transfers : public Core::JSON::Container {
+            private:
+                Transfers(const Transfers&) = delete;
+                Transfers& operator=(const Transfers&) = delete;
+
+            public:
+                Transfers()
+                    : Core::JSON::Container()
+                    , Started(0)
+                    , Failed(0)
+                    , Aborted(0)
+                    , Bytes(0)
+                {
+                    Add(_T("started"), &Started);
+                    Add(_T("failed"), &Failed);
+                    Add(_T("aborted"), &Aborted);
+                    Add(_T("bytes"), &Bytes);
+                }
+                ~Transfers()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Started;
+                Core::JSON::DecUInt32 Failed; // Could not start, the file went out the regular way
+                Core::JSON::DecUInt32 Aborted; // Cut short, mostly by clients going away
+                Core::JSON::DecUInt64 Bytes; // Bodies of the completed ones
+            };
+            class Log : public Core::JSON::Container {
+            private:
+                Log(const Log&) = delete;
+                Log& operator=(const Log&) = delete;
+
+            public:
+                Log()
+                    : Core::JSON::Container()
+                    , Written(0)
+                    , Dropped(0)
+                {
+                    Add(_T("written"), &Written);
+                    Add(_T("dropped"), &Dropped);
+                }
+                ~Log()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Written;
+                Core::JSON::DecUInt32 Dropped; // The writer could not keep up
+            };
+
+        public:
+            Report()
+                : Core::JSON::Container()
+                , Routes()
+                , ProxyCache()
+                , SendFile()
+                , AccessLog()
+            {
+                Add(_T("routes"), &Routes);
+                Add(_T("proxycache"), &ProxyCache);
+                Add(_T("sendfile"), &SendFile);
+                Add(_T("accesslog"), &AccessLog);
+            }
+            ~Report()
+            {
+            }
+
+        public:
+            Core::JSON::ArrayType<Route> Routes;
+            Cache ProxyCache;
+            Transfers SendFile;
+            Log AccessLog;
         };
 
         class RequestFactory {
@@ -185,6 +554,8 @@ namespace Plugin {
         // upholds all other network traffic.
         class ProxyMap {
         private:
+            class Route;
+
             class OutgoingChannel : public Web::WebLinkType<Core::SocketStream, Web::Response, Web::Request, ResponseFactory> {
             private:
                 OutgoingChannel() = delete;
@@ -194,28 +565,37 @@ namespace Plugin {
                 struct OutstandingMessage {
                     Core::ProxyType<Web::Request> Request;
                     uint32_t Id;
+                    string Key; // Of the response cache, empty if the response is not to be kept
+                    bool Credentials; // The request had some, the response is only kept if it is public
+                    std::shared_ptr<const ResponseCache::Entry> Cached; // Being revalidated
+                    bool Conditional; // The client revalidates a copy of its own, a 304 is for the client
                 };
 
             public:
-                OutgoingChannel(const string& path, const string& replacement, ProxyMap& proxyMap, const Core::NodeId& remoteId)
+                OutgoingChannel(ProxyMap& proxyMap, Route& route, const Core::NodeId& remoteId)
                     : Web::WebLinkType<Core::SocketStream, Web::Response, Web::Request, ResponseFactory>(2, false, remoteId.AnyInterface(), remoteId, 1024, 1024)
-                    , _path(path)
-                    , _replacement(replacement)
                     , _outstandingMessages()
                     , _proxyMap(proxyMap)
+                    , _route(route)
+                    , _active(false)
                 {
                 }
 
-                void ProxyRequest(Core::ProxyType<Web::Request>& request, uint32_t id)
+                void ProxyRequest(Core::ProxyType<Web::Request>& request, uint32_t id, const string& key, const bool credentials, const std::shared_ptr<const ResponseCache::Entry>& cached, const bool conditional)
                 {
 
-                    OutstandingMessage message = { request, id };
+                    OutstandingMessage message = { request, id, key, credentials, cached, conditional };
 
                     _outstandingMessages.push_back(message);
+                    _active = true;
 
                     if (_outstandingMessages.size() == 1) {
                         if (IsOpen() == false) {
-                            Open(0);
+                            const uint32_t result = Open(0);
+
+                            if ((result != Core::ERROR_NONE) && (result != Core::ERROR_INPROGRESS)) {
+                                Fail();
+                            }
                         } else {
                             Submit(request);
                         }
@@ -223,9 +603,22 @@ namespace Plugin {
                 }
 
             public:
-                inline const string& Path() const
+                inline uint32_t Outstanding() const
                 {
-                    return (_path);
+                    return (static_cast<uint32_t>(_outstandingMessages.size()));
+                }
+                // The route is gone. Whatever the closing of the connection did not answer yet is answered now.
+                inline void Abandon()
+                {
+                    Fail();
+                }
+                // Closes the connection if nothing happened on it since the previous call.
+                void Evict()
+                {
+                    if ((_active == false) && (_outstandingMessages.empty() == true) && (IsOpen() == true)) {
+                        Close(0);
+                    }
+                    _active = false;
                 }
                 virtual void LinkBody(Core::ProxyType<Web::Response>& response)
                 {
@@ -252,18 +645,223 @@ namespace Plugin {
                         if (!_outstandingMessages.empty()) {
                             Submit(_outstandingMessages.front().Request);
                         }
+                    } else {
+                        // The idle check runs on the timer thread.
+                        _route.Lock();
+
+                        Fail();
+
+                        _route.Unlock();
                     }
                 }
                 virtual void Received(Core::ProxyType<Web::Response>& response);
 
             private:
-                const string _path;
-                const string _replacement;
+                // The connection closed, or did not open: nothing comes back for what is outstanding. The next
+                // request opens the connection again.
+                void Fail()
+                {
+                    while (_outstandingMessages.empty() == false) {
+                        Core::ProxyType<Web::Response> response(PluginHost::Factories::Instance().Response());
+
+                        response->ErrorCode = Web::STATUS_BAD_GATEWAY;
+                        response->Message = _T("Upstream connection failed");
+
+                        _proxyMap.Submit(_outstandingMessages.front().Id, response);
+                        _outstandingMessages.pop_front();
+                    }
+                }
 
+            private:
                 std::list<OutstandingMessage> _outstandingMessages;
                 ProxyMap& _proxyMap;
+                Route& _route;
+                bool _active;
             };
 
+            // All upstream connections for one proxied path. A request goes to the connection with the least
+            // requests waiting for it; a new connection is only made if all of them are busy. The lock keeps
+            // the idle check, on the timer thread, off the connections while they are used.
+            class Route {
+            private:
+                Route() = delete;
+                Route(const Route&) = delete;
+                Route& operator=(const Route&) = delete;
+
+            public:
+                Route(ProxyMap& proxyMap, const string& path, const string& replacement, const Core::NodeId& remoteId, const uint8_t connections, const uint16_t pending, const bool stream)
+                    : _adminLock()
+                    , _path(path)
+                    , _replacement(replacement)
+                    , _remoteId(remoteId)
+                    , _proxyMap(proxyMap)
+                    , _channels()
+                    , _maxConnections(std::max(connections, static_cast<uint8_t>(1)))
+                    , _maxPending(pending)
+                    , _stream(stream)
+                    , _highWater(0)
+                    , _rejected(0)
+                    , _retired(false)
+                {
+                }
+                ~Route()
+                {
+                    ASSERT(_channels.empty() == true);
+                }
+
+            public:
+                inline const string& Path() const
+                {
+                    return (_path);
+                }
+                inline const Core::NodeId& Remote() const
+                {
+                    return (_remoteId);
+                }
+                inline bool IsStreaming() const
+                {
+                    return (_stream);
+                }
+                inline void Lock() const
+                {
+                    _adminLock.Lock();
+                }
+                inline void Unlock() const
+                {
+                    _adminLock.Unlock();
+                }
+                // Requests waiting for a response, over all connections.
+                uint32_t Pending() const
+                {
+                    uint32_t result = 0;
+
+                    _adminLock.Lock();
+
+                    for (std::list<OutgoingChannel*>::const_iterator index(_channels.begin()); index != _channels.end(); index++) {
+                        result += (*index)->Outstanding();
+                    }
+
+                    _adminLock.Unlock();
+
+                    return (result);
+                }
+                // The counters change on the socket thread, the report reads them from the timer thread.
+                uint32_t HighWater() const
+                {
+                    _adminLock.Lock();
+                    const uint32_t result = _highWater;
+                    _adminLock.Unlock();
+
+                    return (result);
+                }
+                uint32_t Rejected() const
+                {
+                    _adminLock.Lock();
+                    const uint32_t result = _rejected;
+                    _adminLock.Unlock();
+
+                    return (result);
+                }
+                uint32_t Connections() const
+                {
+                    _adminLock.Lock();
+                    const uint32_t result = static_cast<uint32_t>(_channels.size());
+                    _adminLock.Unlock();
+
+                    return (result);
+                }
+                // Returns false if the route is full, the request is not taken.
+                bool ProxyRequest(Core::ProxyType<Web::Request>& request, uint32_t id, const string& key, const bool credentials, const std::shared_ptr<const ResponseCache::Entry>& cached, const bool conditional)
+                {
+                    bool result = false;
+
+                    _adminLock.Lock();
+
+                    const uint32_t pending = Pending();
+
+                    if (_retired == true) {
+                        TRACE_L1("Route %s is removed, the request is not proxied", _path.c_str());
+                    } else if ((_maxPending != 0) && (pending >= _maxPending)) {
+                        _rejected++;
+                    } else {
+                        std::list<OutgoingChannel*>::iterator index(_channels.begin());
+                        OutgoingChannel* selected = nullptr;
+
+                        while (index != _channels.end()) {
+                            if ((selected == nullptr) || ((*index)->Outstanding() < selected->Outstanding())) {
+                                selected = *index;
+                            }
+                            index++;
+                        }
+
+                        if ((selected == nullptr) || ((selected->Outstanding() > 0) && (_channels.size() < _maxConnections))) {
+                            selected = new OutgoingChannel(_proxyMap, *this, _remoteId);
+                            _channels.push_back(selected);
+                        }
+
+                        selected->ProxyRequest(request, id, key, credentials, cached, conditional);
+
+                        _highWater = std::max(_highWater, pending + 1);
+                        result = true;
+                    }
+
+                    _adminLock.Unlock();
+
+                    return (result);
+                }
+                void Evict()
+                {
+                    _adminLock.Lock();
+
+                    for (std::list<OutgoingChannel*>::iterator index(_channels.begin()); index != _channels.end(); index++) {
+                        (*index)->Evict();
+                    }
+
+                    _adminLock.Unlock();
+                }
+                // The route is no longer published. Its connections are closed, the socket thread answers what
+                // was outstanding on them, and deleted once that thread is done with them. Whichever thread drops
+                // the last reference to the route then has nothing left to delete. Not for the socket thread.
+                void Retire()
+                {
+                    std::list<OutgoingChannel*> channels;
+
+                    _adminLock.Lock();
+                    _retired = true;
+                    channels.swap(_channels);
+                    _adminLock.Unlock();
+
+                    while (channels.empty() == false) {
+                        OutgoingChannel* channel(channels.front());
+
+                        channel->Close(Core::infinite);
+
+                        _adminLock.Lock();
+                        channel->Abandon();
+                        _adminLock.Unlock();
+
+                        delete channel;
+                        channels.pop_front();
+                    }
+                }
+
+            private:
+                mutable Core::CriticalSection _adminLock;
+                const string _path;
+                const string _replacement;
+                const Core::NodeId _remoteId;
+                ProxyMap& _proxyMap;
+                std::list<OutgoingChannel*> _channels;
+                const uint8_t _maxConnections;
+                const uint16_t _maxPending;
+                const bool _stream;
+                uint32_t _highWater;
+                uint32_t _rejected;
+                bool _retired;
+            };
+
+            typedef PathTrieType<std::shared_ptr<Route>> Routes;
+
         private:
             ProxyMap() = delete;
             ProxyMap(const ProxyMap&) = delete;
@@ -271,22 +869,23 @@ namespace Plugin {
 
         public:
             ProxyMap(ChannelMap& server)
-                : _server(server)
-                , _proxies()
+                : _adminLock()
+                , _server(server)
+                , _routes(std::make_shared<const Routes>())
+                , _responses()
             {
             }
             ~ProxyMap()
             {
-                // Clean up channels in map.
-                while (_proxies.size() > 0) {
-                    delete _proxies.front();
-                    _proxies.pop_front();
-                }
+                Destroy();
             }
 
         public:
             void Create(Core::JSON::ArrayType<Config::Proxy>::ConstIterator& index)
             {
+                _adminLock.Lock();
+
+                std::shared_ptr<Routes> routes(std::make_shared<Routes>(*Current()));
 
                 index.Reset();
 
@@ -298,107 +897,272 @@ namespace Plugin {
 
                     if (address.IsValid() == true) {
 
-                        _proxies.push_back(new OutgoingChannel(path, subst, *this, address));
+                        routes->Insert(path, std::make_shared<Route>(*this, path, subst, address, index.Current().Connections.Value(), index.Current().Pending.Value(), index.Current().Stream.Value()));
                     }
                 }
+
+                Publish(routes);
+
+                _adminLock.Unlock();
             }
 
             void Destroy()
             {
+                std::list<std::shared_ptr<Route>> removed;
 
-                std::list<OutgoingChannel*>::iterator index(_proxies.begin());
+                _adminLock.Lock();
 
-                while (index != _proxies.end()) {
+                Current()->Visit([&](const std::shared_ptr<Route>& route) {
+                    removed.push_back(route);
+                });
 
-                    delete (*index);
+                Publish(std::make_shared<Routes>());
 
-                    index++;
-                }
-                _proxies.clear();
+                _adminLock.Unlock();
+
+                Retire(removed);
             }
 
+            // Lookups do not lock, they work on the routes as they were published when the lookup started.
             bool Relay(Core::ProxyType<Web::Request>& request, uint32_t channelId)
             {
+                std::shared_ptr<Route> route(Current()->Find(request->Path));
 
-                bool found = false;
-                const string& originalPath = request->Path;
-                std::list<OutgoingChannel*>::iterator index(_proxies.begin());
-                string proxyPath;
-
-                while ((found == false) && (index != _proxies.end())) {
+                // If we didn't find relay instructions for this path, return false.
+                if (route != nullptr) {
+                    std::shared_ptr<const ResponseCache::Entry> cached;
+                    string key(_responses.IsEnabled() == true ? ResponseCache::Key(*request) : string());
+                    const bool credentials(ResponseCache::Credentials(*request));
+                    ResponseCache::state state(key.empty() == true ? ResponseCache::MISS : _responses.Lookup(key, credentials, cached));
+                    string tags;
+                    const bool revalidating(Fields::IfNoneMatch(*request, tags));
+
+                    if (state == ResponseCache::FRESH) {
+                        Reply(channelId, *cached, tags);
+                    } else if ((state == ResponseCache::STALE) && (revalidating == false) && (Fields::SetIfNoneMatch(*request, cached->ETag) == false)) {
+                        // The framework can not ask if ours is still good, the full response replaces it.
+                        cached.reset();
+                    }
 
-                    proxyPath = (*index)->Path();
+                    // If the client revalidates a copy of its own, the 304 is for the client. It only refreshes
+                    // ours if it names the same entity tag.
+                    if ((state != ResponseCache::FRESH) && (route->ProxyRequest(request, channelId, key, credentials, cached, revalidating) == false)) {
+                        // Too much waiting already, do not make it worse. Or the route was just removed.
+                        Core::ProxyType<Web::Response> response(PluginHost::Factories::Instance().Response());
 
-                    uint32_t checkSize(static_cast<uint32_t>(proxyPath.length()));
+                        response->ErrorCode = Web::STATUS_SERVICE_UNAVAILABLE;
+                        response->Message = _T("Proxy queue is full");
 
-                    // If path starts with mapped string, we should relay.
-                    if (((originalPath.length() == checkSize) || ((originalPath.length() > checkSize) && (originalPath[checkSize] == '/'))) && (originalPath.compare(0, checkSize, proxyPath) == 0)) {
-                        found = true;
-                    } else {
-                        index++;
+                        _server.Submit(channelId, response);
                     }
                 }
 
-                // If we didn't find relay instructions for this path, return false.
-                if (found == true) {
+                return (route != nullptr);
+            }
 
-                    request->Path = (proxyPath + request->Path.substr(proxyPath.length()));
+            // Returns true if the path goes to a route that streams, the upstream server is returned.
+            bool Streamed(const string& path, Core::NodeId& remote) const
+            {
+                std::shared_ptr<Route> route(Current()->Find(path));
+                bool result = ((route != nullptr) && (route->IsStreaming() == true));
 
-                    (*index)->ProxyRequest(request, channelId);
+                if (result == true) {
+                    remote = route->Remote();
                 }
 
-                return (found);
+                return (result);
+            }
+
+            // The path of the route the path goes to, empty if it is not proxied.
+            string Proxied(const string& path) const
+            {
+                std::shared_ptr<Route> route(Current()->Find(path));
+
+                return (route != nullptr ? route->Path() : string());
+            }
+            std::list<string> Paths() const
+            {
+                std::list<string> result;
+
+                Current()->Visit([&](const std::shared_ptr<Route>& route) {
+                    result.push_back(route->Path());
+                });
+
+                return (result);
+            }
+            // Adds how busy the upstream connections are, if the path is that of a route.
+            void Describe(const string& path, Report::Route& entry) const
+            {
+                std::shared_ptr<Route> route(Current()->Find(path));
+
+                if ((route != nullptr) && (route->Path() == path)) {
+                    entry.Connections = route->Connections();
+                    entry.Pending = route->Pending();
+                    entry.HighWater = route->HighWater();
+                    entry.Rejected = route->Rejected();
+                }
             }
 
+            // Adding and removing routes builds a new set of routes, next to the one in use.
             inline void AddProxy(const string& path, const string& subst, const string& address)
             {
                 const Core::NodeId node(address.c_str());
 
                 if (node.IsValid() == true) {
+                    Config::Proxy defaults;
+
+                    _adminLock.Lock();
+
+                    std::shared_ptr<Routes> routes(std::make_shared<Routes>(*Current()));
 
-                    _proxies.push_back(new OutgoingChannel(path, subst, *this, node));
+                    if (routes->Insert(path, std::make_shared<Route>(*this, path, subst, node, defaults.Connections.Value(), defaults.Pending.Value(), defaults.Stream.Value())) == true) {
+                        Publish(routes);
+                    }
+
+                    _adminLock.Unlock();
                 }
             }
             inline void RemoveProxy(const string& path)
             {
-                std::list<OutgoingChannel*>::iterator index(_proxies.begin());
+                std::list<std::shared_ptr<Route>> removed;
 
-                while ((index != _proxies.end()) && ((*index)->Path() != path)) {
+                _adminLock.Lock();
 
-                    index++;
+                std::shared_ptr<Routes> routes(std::make_shared<Routes>(*Current()));
+                std::shared_ptr<Route> route(routes->Remove(path));
+
+                if (route != nullptr) {
+                    Publish(routes);
+                    removed.push_back(route);
                 }
 
-                if (index != _proxies.end()) {
+                _adminLock.Unlock();
 
-                    delete (*index);
-                    _proxies.erase(index);
-                }
+                Retire(removed);
             }
             inline void Submit(uint32_t channelId, Core::ProxyType<Web::Response>& response)
             {
                 _server.Submit(channelId, response);
             }
+            inline ResponseCache& Responses()
+            {
+                return (_responses);
+            }
+            // Answers a client from the response cache, with a 304 if the client has the same response already.
+            void Reply(uint32_t channelId, const ResponseCache::Entry& entry, const string& tags)
+            {
+                Core::ProxyType<Web::Response> response(PluginHost::Factories::Instance().Response());
+
+                ResponseCache::Answer(entry, *response);
+
+                if ((entry.ETag.empty() == false) && ((tags == _T("*")) || (tags.find(entry.ETag) != string::npos))) {
+                    response->ErrorCode = Web::STATUS_NOT_MODIFIED;
+                    response->Message = _T("Not Modified");
+                } else {
+                    Core::ProxyType<Web::TextBody> body(_textBodies.Element());
+
+                    *body = entry.Body;
+                    response->ErrorCode = Web::STATUS_OK;
+                    response->Message = _T("OK");
+                    response->Body<Web::TextBody>(body);
+                }
+
+                _server.Submit(channelId, response);
+            }
+            // Upstream connections that were idle since the previous call are closed, they are opened again
+            // on demand.
+            void Evict()
+            {
+                Current()->Visit([](const std::shared_ptr<Route>& route) {
+                    route->Evict();
+                });
+            }
+
+        private:
+            // Lookups that started before the routes were published may still hold them, they find them
+            // retired: nothing more is taken.
+            static void Retire(std::list<std::shared_ptr<Route>>& routes)
+            {
+                for (std::list<std::shared_ptr<Route>>::iterator index(routes.begin()); index != routes.end(); index++) {
+                    (*index)->Retire();
+                }
+            }
+            inline std::shared_ptr<const Routes> Current() const
+            {
+                return (std::atomic_load(&_routes));
+            }
+            inline void Publish(const std::shared_ptr<const Routes>& routes)
+            {
+                std::atomic_store(&_routes, routes);
+            }
 
         private:
+            Core::CriticalSection _adminLock;
             ChannelMap& _server;
-            std::list<OutgoingChannel*> _proxies;
+            std::shared_ptr<const Routes> _routes;
+            ResponseCache _responses;
         };
 
         class IncomingChannel : public Web::WebLinkType<Core::SocketStream, Web::Request, Web::Response, RequestFactory> {
         private:
+            typedef SendFileType<IncomingChannel> Transfer;
+            typedef ProxyStreamType<IncomingChannel> Stream;
+
+            // A request, from the moment it came in until its response is out. Responses go out in the order
+            // the requests came in, so the oldest one is always the one that is answered next.
+            struct Timing {
+                uint64_t Received;
+                uint64_t FirstByte;
+                uint16_t Status; // Of a response sent straight from a file
+                uint64_t Bytes; // Of a response sent straight from a file
+                Web::Request::type Verb;
+                string Path; // Only kept for the access log
+                string Route;
+            };
+
             IncomingChannel() = delete;
             IncomingChannel(const IncomingChannel& copy) = delete;
             IncomingChannel& operator=(const IncomingChannel&) = delete;
 
         public:
+#ifdef __WIN32__
+#pragma warning(disable : 4355)
+#endif
             IncomingChannel(const SOCKET& connector, const Core::NodeId& remoteId, Core::SocketServerType<IncomingChannel>* parent)
                 : Web::WebLinkType<Core::SocketStream, Web::Request, Web::Response, RequestFactory>(2, false, connector, remoteId, 1024, 1024)
                 , _id(0)
                 , _parent(static_cast<ChannelMap&>(*parent))
+                , _transfer(*this)
+                , _stream(*this)
+                , _held()
+                , _pending(0)
+                , _timings()
             {
             }
+#ifdef __WIN32__
+#pragma warning(default : 4355)
+#endif
             virtual ~IncomingChannel()
             {
+                _transfer.Abort();
+                _stream.Abort();
+            }
+
+        public:
+            // A response from an upstream server, or from the cache, relayed by the ProxyMap. It was counted as
+            // pending when the request was relayed.
+            void Relayed(Core::ProxyType<Web::Response>& response)
+            {
+                Deliver(response);
+            }
+            // A file or an upstream response that goes out around the link is activity on the link too, as long
+            // as it moves.
+            bool Progressed()
+            {
+                const bool transferred = _transfer.Progressed();
+                const bool streamed = _stream.Progressed();
+
+                return ((transferred == true) || (streamed == true));
             }
 
         private:
@@ -418,14 +1182,371 @@ namespace Plugin {
             virtual void Send(const Core::ProxyType<Web::Response>& response)
             {
                 TRACE(WebFlow, (response));
+
+                ASSERT(_pending > 0);
+                _pending--;
+
+                Completed(static_cast<uint16_t>(response->ErrorCode), Fields::ContentLength(*response));
             }
             virtual void StateChange()
             {
+                if (IsOpen() == false) {
+                    _transfer.Abort();
+                    _stream.Abort();
+                    _held.clear();
+                    _pending = 0;
+                    _timings.clear();
+                }
             }
             virtual void Received(Core::ProxyType<Web::Request>& request);
 
+            // While a file or an upstream response is sent straight to the socket, nothing else may be written
+            // to it. Responses are held back until that is done.
+            inline bool IsOwned() const
+            {
+                return ((_transfer.IsActive() == true) || (_stream.IsActive() == true));
+            }
+            // A response is pending from the moment it is known to come, held back or not, until it is written.
+            void Respond(Core::ProxyType<Web::Response>& response)
+            {
+                _pending++;
+
+                Deliver(response);
+            }
+            void Deliver(Core::ProxyType<Web::Response>& response)
+            {
+                if (IsOwned() == true) {
+                    _held.push_back(response);
+                } else {
+                    Timing* timing(Unanswered());
+
+                    if (timing != nullptr) {
+                        timing->FirstByte = Core::Time::Now().Ticks();
+                    }
+
+                    Submit(response);
+                }
+            }
+            Timing* Unanswered()
+            {
+                std::list<Timing>::iterator index(_timings.begin());
+
+                while ((index != _timings.end()) && (index->FirstByte != 0)) {
+                    index++;
+                }
+
+                return (index != _timings.end() ? &(*index) : nullptr);
+            }
+            // The oldest request is answered, a status of 0 if the response was cut short.
+            void Completed(const uint16_t status, const uint64_t bytes)
+            {
+                if (_timings.empty() == false) {
+                    const Timing& timing(_timings.front());
+                    const uint64_t now = Core::Time::Now().Ticks();
+                    AccessLog::Entry entry;
+
+                    entry.Time = timing.Received;
+                    entry.Path = timing.Path;
+                    entry.Route = timing.Route;
+                    entry.Status = status;
+                    entry.Bytes = bytes;
+                    entry.FirstByte = (timing.FirstByte != 0 ? timing.FirstByte : now) - timing.Received;
+                    entry.Total = now - timing.Received;
+
+                    if (_parent.IsLogging() == true) {
+                        entry.Remote = Link().RemoteId();
+                        entry.Method = Core::EnumerateType<Web::Request::type>(timing.Verb).Data();
+                    }
+
+                    _parent.Measured(entry);
+
+                    _timings.pop_front();
+                }
+            }
+            // Sends the file, or the requested ranges of it, straight to the socket. Returns false, with the
+            // response as it was, if it should go out the regular way.
+            bool SendFile(const Web::Request& request, Core::ProxyType<Web::Response>& response, const string& fileName)
+            {
+                bool result = false;
+                uint64_t size = 0;
+                uint64_t modified = 0;
+                const uint32_t threshold = _parent.SendFileThreshold();
+
+                // The header goes out through our own descriptor, so everything submitted before must be out.
+                if ((_pending == 0) && (IsOwned() == false) && (Transfer::Stat(fileName, size, modified) == true)) {
+                    std::vector<ByteRanges::Range> ranges;
+                    ByteRanges::state state = ByteRanges::ENTIRE;
+                    string range;
+
+                    if ((Fields::Range(request, range) == true) && (IfRange(request, fileName, modified) == true)) {
+                        state = ByteRanges::Parse(range, size, ranges);
+                    }
+
+                    if ((state != ByteRanges::ENTIRE) || ((threshold != 0) && (size >= threshold))) {
+                        const string total(Core::NumberType<uint64_t>(size).Text());
+                        std::list<Transfer::Segment> segments;
+                        uint64_t body = 0;
+                        string header;
+
+                        // Fields that are not the response's own go straight into its text, so if the
+                        // transfer does not start, the response is as it was.
+                        if (state == ByteRanges::UNSATISFIABLE) {
+                            response->ErrorCode = Web::STATUS_REQUESTED_RANGE_NOT_SATISFIABLE;
+                            response->Message = _T("Requested Range Not Satisfiable");
+                            response->ToString(header);
+
+                            Field(header, _T("Content-Length"), _T("0"));
+                            Field(header, _T("Content-Range"), _T("bytes */") + total);
+                            Add(segments, header, 0, 0);
+                        } else if (state == ByteRanges::ENTIRE) {
+                            response->ToString(header);
+
+                            Field(header, _T("Content-Length"), total);
+                            Add(segments, header, 0, size);
+                            body = size;
+                        } else {
+                            response->ErrorCode = Web::STATUS_PARTIAL_CONTENT;
+                            response->Message = _T("Partial Content");
+                            response->ToString(header);
+
+                            if (ranges.size() == 1) {
+                                Field(header, _T("Content-Length"), Core::NumberType<uint64_t>(ranges.front().Length()).Text());
+                                Field(header, _T("Content-Range"), Bytes(ranges.front()) + '/' + total);
+                                Add(segments, header, ranges.front().First, ranges.front().Length());
+                                body = ranges.front().Length();
+                            } else {
+                                // Every range becomes a part of a multipart/byteranges body.
+                                const string boundary(_T("WebServer-") + Core::NumberType<uint64_t>(Core::Time::Now().Ticks()).Text());
+                                const string type(Field(header, _T("Content-Type"), _T("multipart/byteranges; boundary=") + boundary));
+                                uint64_t length = 0;
+
+                                Add(segments, string(), 0, 0);
+
+                                for (std::vector<ByteRanges::Range>::const_iterator index(ranges.begin()); index != ranges.end(); index++) {
+                                    string part(_T("\r\n--") + boundary + _T("\r\n"));
+
+                                    if (type.empty() == false) {
+                                        part += _T("Content-Type: ") + type + _T("\r\n");
+                                    }
+                                    part += _T("Content-Range: ") + Bytes(*index) + '/' + total + _T("\r\n\r\n");
+
+                                    length += part.length() + index->Length();
+                                    Add(segments, part, index->First, index->Length());
+                                }
+
+                                Add(segments, _T("\r\n--") + boundary + _T("--\r\n"), 0, 0);
+                                length += segments.back().Text.length();
+
+                                Field(header, _T("Content-Length"), Core::NumberType<uint64_t>(length).Text());
+                                body = length;
+                            }
+                        }
+
+                        Field(header, _T("Last-Modified"), Core::Time(modified).ToRFC1123(false));
+                        Field(header, _T("Accept-Ranges"), _T("bytes"));
+                        segments.front().Text = header;
+
+                        if (_transfer.Start(Descriptor(Link(), 0), fileName, segments) == true) {
+                            Timing* timing(Unanswered());
+
+                            TRACE(WebFlow, (response));
+
+                            if (timing != nullptr) {
+                                timing->FirstByte = Core::Time::Now().Ticks();
+                                timing->Status = static_cast<uint16_t>(response->ErrorCode);
+                                timing->Bytes = body;
+                            }
+
+                            _parent.Started();
+                            result = true;
+                        } else {
+                            _parent.Failed();
+                            response->ErrorCode = Web::STATUS_OK;
+                            response->Message = _T("OK");
+                        }
+                    }
+                }
+
+                return (result);
+            }
+            // Without an If-Range, or if it still holds, the ranges are sent. Otherwise it all goes.
+            bool IfRange(const Web::Request& request, const string& fileName, const uint64_t modified)
+            {
+                string validator;
+                bool result = (Fields::IfRange(request, validator) == false);
+
+                if (result == false) {
+                    if ((validator.empty() == false) && (validator[0] == '"')) {
+                        // Only a strong validator will do, weak ones ("W/...") never match.
+                        _parent.Assets().Use(fileName, [&](const AssetCache::Asset& asset) {
+                            result = (asset.ETag == validator);
+                        });
+                    } else {
+                        result = (Core::Time(modified).ToRFC1123(false) == validator);
+                    }
+                }
+
+                return (result);
+            }
+            // The socket of the link, if the framework gives it out. Without it, nothing is sent around the
+            // link: transfers and streams do not start and the response goes out the regular way.
+            template <typename LINK>
+            static auto Descriptor(const LINK& link, int) -> decltype(static_cast<Core::IResource::handle>(link.Descriptor()))
+            {
+                return (link.Descriptor());
+            }
+            template <typename LINK>
+            static Core::IResource::handle Descriptor(const LINK&, long)
+            {
+                return (-1);
+            }
+            static string Bytes(const ByteRanges::Range& range)
+            {
+                return (_T("bytes ") + Core::NumberType<uint64_t>(range.First).Text() + '-' + Core::NumberType<uint64_t>(range.Last).Text());
+            }
+            static void Add(std::list<Transfer::Segment>& segments, const string& text, const uint64_t offset, const uint64_t length)
+            {
+                Transfer::Segment segment;
+
+                segment.Text = text;
+                segment.Offset = offset;
+                segment.Length = length;
+
+                segments.push_back(segment);
+            }
+            // Sets a field in a serialized header, returns the value it replaced (if any).
+            static string Field(string& header, const TCHAR name[], const string& value)
+            {
+                string result;
+                string lowered(header);
+                string key(_T("\r\n"));
+
+                key += name;
+                key += ':';
+
+                std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+                std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+
+                size_t start = lowered.find(key);
+
+                if (start != string::npos) {
+                    size_t begin = header.find_first_not_of(_T(" \t"), start + key.length());
+                    size_t end = header.find(_T("\r\n"), start + key.length());
+
+                    result = header.substr(begin, end - begin);
+                    header.replace(start + 2, end - start - 2, string(name) + _T(": ") + value);
+                } else {
+                    size_t end = header.find(_T("\r\n\r\n"));
+
+                    ASSERT(end != string::npos);
+
+                    header.insert(end, _T("\r\n") + string(name) + _T(": ") + value);
+                }
+
+                return (result);
+            }
+            // Returns false if the request should be relayed the regular way, if at all.
+            bool Streaming(const Core::ProxyType<Web::Request>& request)
+            {
+                bool result = false;
+                Core::NodeId remote;
+
+                // The response goes out through our own descriptor, so everything submitted before must be out.
+                if ((_pending == 0) && (IsOwned() == false) && (_parent.Streamed(request->Path, remote) == true)) {
+                    string text;
+
+                    request->ToString(text);
+                    Field(text, _T("Connection"), _T("close"));
+
+                    result = _stream.Start(Descriptor(Link(), 0), remote, text);
+                }
+
+                return (result);
+            }
+            void Streamed(const bool completed)
+            {
+                if (_timings.empty() == false) {
+                    _timings.front().FirstByte = _stream.FirstByte();
+                }
+
+                // The size is what came from the upstream server, its header included.
+                Completed((completed == true ? _stream.Status() : 0), _stream.Relayed());
+
+                // The upstream server closed the connection after its response, so do we. If the response was
+                // cut short, closing is the only way left to tell the client.
+                _held.clear();
+                Close(0);
+            }
+            void Transferred(const bool completed)
+            {
+                _parent.Finished(completed, (_timings.empty() == false ? _timings.front().Bytes : 0));
+
+                if (_timings.empty() == false) {
+                    Completed((completed == true ? _timings.front().Status : 0), _timings.front().Bytes);
+                }
+
+                if (completed == false) {
+                    // The response is cut short, the client can only tell by the connection closing.
+                    _held.clear();
+                    Close(0);
+                } else {
+                    while ((_held.empty() == false) && (_transfer.IsActive() == false)) {
+                        Core::ProxyType<Web::Response> response(_held.front());
+
+                        _held.pop_front();
+                        Deliver(response);
+                    }
+                }
+            }
+
+            // Does the Accept-Encoding header take the coding, i.e. it is listed (or "*" is) without a q=0.
+            static bool Accepts(const string& header, const TCHAR coding[])
+            {
+                bool listed = false;
+                bool result = false;
+                size_t start = 0;
+
+                while ((listed == false) && (start < header.length())) {
+                    size_t end = header.find(',', start);
+                    const string token(header.substr(start, end == string::npos ? string::npos : end - start));
+                    const size_t parameters = token.find(';');
+                    const size_t first = token.find_first_not_of(_T(" \t"));
+                    const size_t last = token.find_last_not_of(_T(" \t"), parameters == string::npos ? string::npos : parameters - 1);
+                    const string name(first != string::npos && last != string::npos && last >= first ? token.substr(first, last - first + 1) : string());
+
+                    if ((name == coding) || (name == _T("*"))) {
+                        // An explicit listing beats the wildcard, whatever comes first.
+                        size_t quality = (parameters == string::npos ? string::npos : token.find(_T("q="), parameters));
+
+                        listed = (name == coding);
+                        result = ((quality == string::npos) || (::atof(token.c_str() + quality + 2) > 0.0));
+                    }
+
+                    start = (end == string::npos ? header.length() : end + 1);
+                }
+
+                return (result);
+            }
+            // If-None-Match takes precedence, If-Modified-Since only has a resolution of seconds.
+            static bool NotModified(const Web::Request& request, const AssetCache::Asset& asset)
+            {
+                bool result = false;
+                string tags;
+                Core::Time since;
+
+                if (Fields::IfNoneMatch(request, tags) == true) {
+                    result = ((tags == _T("*")) || (tags.find(asset.ETag) != string::npos));
+                } else if (Fields::IfModifiedSince(request, since) == true) {
+                    result = ((asset.Modified.Ticks() / (1000 * 1000)) <= (since.Ticks() / (1000 * 1000)));
+                }
+
+                return (result);
+            }
+
         private:
             friend class Core::SocketServerType<IncomingChannel>;
+            friend class SendFileType<IncomingChannel>;
+            friend class ProxyStreamType<IncomingChannel>;
 
             inline void Id(const uint32_t id)
             {
@@ -435,6 +1556,11 @@ namespace Plugin {
         private:
             uint32_t _id;
             ChannelMap& _parent;
+            Transfer _transfer;
+            Stream _stream;
+            std::list<Core::ProxyType<Web::Response>> _held;
+            uint32_t _pending;
+            std::list<Timing> _timings;
         };
 
         class ChannelMap : public Core::SocketServerType<IncomingChannel> {
@@ -448,14 +1574,17 @@ namespace Plugin {
             public:
                 TimeHandler()
                     : _parent(nullptr)
+                    , _report(false)
                 {
                 }
-                TimeHandler(ChannelMap& parent)
+                TimeHandler(ChannelMap& parent, const bool report = false)
                     : _parent(&parent)
+                    , _report(report)
                 {
                 }
                 TimeHandler(const TimeHandler& copy)
                     : _parent(copy._parent)
+                    , _report(copy._report)
                 {
                 }
                 ~TimeHandler()
@@ -465,6 +1594,7 @@ namespace Plugin {
                 TimeHandler& operator=(const TimeHandler& RHS)
                 {
                     _parent = RHS._parent;
+                    _report = RHS._report;
                     return (*this);
                 }
 
@@ -473,11 +1603,12 @@ namespace Plugin {
                 {
                     ASSERT(_parent != nullptr);
 
-                    return (_parent->Timed(scheduledTime));
+                    return (_report == false ? _parent->Timed(scheduledTime) : _parent->Snapshot(scheduledTime));
                 }
 
             private:
                 ChannelMap* _parent;
+                bool _report;
             };
 
         public:
@@ -491,6 +1622,16 @@ namespace Plugin {
                 , _connectionCheckTimer(0)
                 , _cleanupTimer(Core::Thread::DefaultStackSize(), _T("ConnectionChecker"))
                 , _proxyMap(*this)
+                , _assetCache()
+                , _sendFileThreshold(0)
+                , _started(0)
+                , _failed(0)
+                , _aborted(0)
+                , _sent(0)
+                , _metrics()
+                , _accessLog()
+                , _reportFile()
+                , _reportInterval(0)
             {
             }
 #ifdef __WIN32__
@@ -512,10 +1653,17 @@ namespace Plugin {
 
                 // Cleanup the closed sockets we created..
                 Cleanup();
+
+#ifndef __WIN32__
+                // What is not there, is not served as if it was current.
+                if (_reportFile.empty() == false) {
+                    ::unlink(_reportFile.c_str());
+                }
+#endif
             }
 
         public:
-            inline uint32_t Configure(const string& prefixPath, const Config& configuration)
+            inline uint32_t Configure(const string& prefixPath, const string& reportFile, const Config& configuration)
             {
                 Core::NodeId accessor;
                 uint32_t result(Core::ERROR_INCOMPLETE_CONFIG);
@@ -529,6 +1677,19 @@ namespace Plugin {
                 }
 
                 _proxyMap.Create(index);
+                _proxyMap.Responses().Configure(configuration.ProxyCache.Value() * 1024);
+
+                _sendFileThreshold = configuration.SendFile.Value() * 1024;
+
+                _assetCache.Clear();
+                _assetCache.Configure(configuration.Assets.Size.Value() * 1024, configuration.Assets.File.Value() * 1024);
+
+                _reportFile = reportFile;
+                _reportInterval = configuration.Statistics.Value() * 1000;
+
+                if ((configuration.AccessLog.Value().empty() == false) && (_accessLog.IsOpen() == false) && (_accessLog.Open(configuration.AccessLog.Value()) != Core::ERROR_NONE)) {
+                    TRACE_L1("Could not open the access log: %s", configuration.AccessLog.Value().c_str());
+                }
 
                 if (configuration.Interface.Value().empty() == false) {
                     Core::NodeId selectedNode = Plugin::Config::IPV4UnicastNode(configuration.Interface.Value());
@@ -569,6 +1730,9 @@ namespace Plugin {
 
                         _cleanupTimer.Schedule(NextTick.Ticks(), TimeHandler(*this));
                     }
+                    if ((_reportFile.empty() == false) && (_reportInterval != 0)) {
+                        _cleanupTimer.Schedule(Core::Time::Now().Ticks(), TimeHandler(*this, true));
+                    }
                     result = Core::ERROR_NONE;
                 }
 
@@ -586,6 +1750,105 @@ namespace Plugin {
             {
                 return (_prefixPath);
             }
+            inline uint32_t SendFileThreshold() const
+            {
+                return (_sendFileThreshold);
+            }
+            // How the sendfile() transfers fared, so its use can be judged on the device itself.
+            inline void Started()
+            {
+                _started++;
+            }
+            inline void Failed()
+            {
+                _failed++;
+            }
+            inline void Finished(const bool completed, const uint64_t bytes)
+            {
+                if (completed == true) {
+                    _sent += bytes;
+                } else {
+                    _aborted++;
+                }
+            }
+            inline AssetCache& Assets()
+            {
+                return (_assetCache);
+            }
+            inline bool Streamed(const string& path, Core::NodeId& remote) const
+            {
+                return (_proxyMap.Streamed(path, remote));
+            }
+            inline string Proxied(const string& path) const
+            {
+                return (_proxyMap.Proxied(path));
+            }
+            inline bool IsLogging() const
+            {
+                return (_accessLog.IsOpen());
+            }
+            void Measured(const AccessLog::Entry& entry)
+            {
+                _metrics.Add(entry.Route, entry.Status, entry.Bytes, entry.FirstByte, entry.Total);
+
+                if (_accessLog.IsOpen() == true) {
+                    _accessLog.Log(entry);
+                }
+            }
+            void Statistics(Report& report)
+            {
+                std::list<string> proxies(_proxyMap.Paths());
+
+                _metrics.Visit([&](const string& path, const Metrics::Route& route) {
+                    Report::Route entry;
+
+                    entry.Path = path;
+                    entry.Requests = route.Requests;
+                    entry.ClientErrors = route.ClientErrors;
+                    entry.ServerErrors = route.ServerErrors;
+                    entry.Bytes = route.Bytes;
+                    entry.FirstByte.Set(route.FirstByte);
+                    entry.Total.Set(route.Total);
+                    entry.Size.Set(route.Size);
+
+                    _proxyMap.Describe(path, entry);
+                    report.Routes.Add(entry);
+
+                    proxies.remove(path);
+                });
+
+                // Proxies that did not see a request yet.
+                for (std::list<string>::const_iterator index(proxies.begin()); index != proxies.end(); index++) {
+                    Report::Route entry;
+
+                    entry.Path = *index;
+
+                    _proxyMap.Describe(*index, entry);
+                    report.Routes.Add(entry);
+                }
+
+                report.ProxyCache.Hits = _proxyMap.Responses().Hits();
+                report.ProxyCache.Misses = _proxyMap.Responses().Misses();
+                report.ProxyCache.Revalidations = _proxyMap.Responses().Revalidations();
+                report.ProxyCache.Size = _proxyMap.Responses().Size();
+
+                report.SendFile.Started = _started.load();
+                report.SendFile.Failed = _failed.load();
+                report.SendFile.Aborted = _aborted.load();
+                report.SendFile.Bytes = _sent.load();
+
+                report.AccessLog.Written = _accessLog.Written();
+                report.AccessLog.Dropped = _accessLog.Dropped();
+            }
+            // Responses relayed by the ProxyMap go out through their channel, so it can tell when they did.
+            void Submit(const uint32_t id, Core::ProxyType<Web::Response>& response)
+            {
+                Core::ProxyType<IncomingChannel> channel(BaseClass::Client(id));
+
+                if (channel.IsValid() == true) {
+                    channel->Relayed(response);
+                }
+            }
             inline bool Relay(Core::ProxyType<Web::Request>& request, const uint32_t id)
             {
                 return (_proxyMap.Relay(request, id));
@@ -616,11 +1879,17 @@ namespace Plugin {
                 // First clear all shit from last time..
                 Cleanup();
 
+                // Upstream connections that are not used, go as well.
+                _proxyMap.Evict();
+
                 // Now suspend those that have no activity.
                 BaseClass::Iterator index(BaseClass::Clients());
 
                 while (index.Next() == true) {
-                    if (index.Client()->HasActivity() == false) {
+                    // Ask every time, so what moved before the previous check is not counted again.
+                    const bool progressed = index.Client()->Progressed();
+
+                    if ((index.Client()->HasActivity() == false) && (progressed == false)) {
                         // Oops nothing hapened for a long time, kill the connection
                         // Give it all the time (0) if it i not yet suspended to close. If it is
                         // suspended, force the close down if not closed in 100ms.
@@ -632,6 +1901,33 @@ namespace Plugin {
 
                 return (NextTick.Ticks());
             }
+            // Written aside and moved in place, so the plugin never serves half a report.
+            uint64_t Snapshot(const uint64_t scheduledTime)
+            {
+                Core::Time NextTick(Core::Time::Now());
+                Report report;
+                string text;
+
+                NextTick.Add(_reportInterval);
+
+                Statistics(report);
+                report.ToString(text);
+#ifndef __WIN32__
+                const string temporary(_reportFile + _T(".new"));
+                int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+                if (fd != -1) {
+                    const bool written = (::write(fd, text.c_str(), text.length()) == static_cast<ssize_t>(text.length()));
+
+                    ::close(fd);
+
+                    if ((written == false) || (::rename(temporary.c_str(), _reportFile.c_str()) != 0)) {
+                        ::unlink(temporary.c_str());
+                    }
+                }
+#endif
+                return (NextTick.Ticks());
+            }
 
         private:
             string _accessor;
@@ -639,6 +1935,16 @@ namespace Plugin {
             uint32_t _connectionCheckTimer;
             Core::TimerType<TimeHandler> _cleanupTimer;
             ProxyMap _proxyMap;
+            AssetCache _assetCache;
+            uint32_t _sendFileThreshold;
+            std::atomic<uint32_t> _started;
+            std::atomic<uint32_t> _failed;
+            std::atomic<uint32_t> _aborted;
+            std::atomic<uint64_t> _sent;
+            Metrics _metrics;
+            AccessLog _accessLog;
+            string _reportFile;
+            uint32_t _reportInterval;
         };
 
     private:
@@ -663,7 +1969,14 @@ namespace Plugin {
             Config config;
             config.FromString(service->ConfigLine());
 
-            uint32_t result(_channelServer.Configure(service->DataPath(), config));
+            const string unsupported(Unsupported());
+
+            if (unsupported.empty() == false) {
+                SYSLOG(Logging::Startup, (_T("The framework lacks the header fields for: %s"), unsupported.c_str()));
+            }
+
+            // The plugin serves the report from this file.
+            uint32_t result(_channelServer.Configure(service->DataPath(), service->VolatilePath() + service->Callsign() + _T("-statistics.json"), config));
 
             if (result == Core::ERROR_NONE) {
 
@@ -737,30 +2050,96 @@ namespace Plugin {
 
         TRACE(WebFlow, (Core::proxy_cast<Web::Request>(request)));
 
-        // Check if the channel server will relay this message.
-        if (_parent.Relay(request, Id()) == false) {
+        Timing timing;
 
-            Core::ProxyType<Web::Response> response(PluginHost::Factories::Instance().Response());
-            Core::ProxyType<Web::FileBody> fileBody(PluginHost::Factories::Instance().FileBody());
+        timing.Received = Core::Time::Now().Ticks();
+        timing.FirstByte = 0;
+        timing.Status = 0;
+        timing.Bytes = 0;
+        timing.Verb = request->Verb;
+        timing.Route = _parent.Proxied(request->Path);
 
-            // If so, don't deal with it ourselves.
-            Web::MIMETypes result;
-            string fileToService = _parent.PrefixPath();
+        if (_parent.IsLogging() == true) {
+            timing.Path = request->Path;
+        }
 
-            if (Web::MIMETypeForFile(request->Path, fileToService, result) == false) {
+        _timings.push_back(timing);
 
-                string fullPath = fileToService + _T("index.html");
+        // Streaming routes pass the response on as it comes in from the upstream server.
+        if (Streaming(request) == false) {
+
+            // The response comes back through the ProxyMap, but it is written all the same. It may come back
+            // right away, from the cache, so it is pending before it is relayed.
+            _pending++;
+
+            // Check if the channel server will relay this message.
+            if (_parent.Relay(request, Id()) == false) {
+                _pending--;
+
+                Core::ProxyType<Web::Response> response(PluginHost::Factories::Instance().Response());
+
+                // If so, don't deal with it ourselves.
+                Web::MIMETypes result;
+                string fileToService = _parent.PrefixPath();
+
+                if (Web::MIMETypeForFile(request->Path, fileToService, result) == false) {
+                    // No filename gives, be default, we go for the index.html page..
+                    fileToService += _T("index.html");
+                    result = Web::MIME_HTML;
+                }
 
-                // No filename gives, be default, we go for the index.html page..
-                *fileBody = fileToService + _T("index.html");
-                response->ContentType = Web::MIME_HTML;
-                response->Body<Web::FileBody>(fileBody);
-            } else {
-                *fileBody = fileToService;
                 response->ContentType = result;
-                response->Body<Web::FileBody>(fileBody);
+
+                // Go for a precompressed variant of the file, if there is one the client takes. A variant is
+                // only sent if the response can say what it is, and the caches along the way that it varies.
+                string encodings;
+                string range;
+
+                if (Fields::AcceptEncoding(*request, encodings) == true) {
+                    string fileName(fileToService);
+
+                    for (uint8_t index = 0; index < (sizeof(_variants) / sizeof(_variants[0])); index++) {
+                        if ((_parent.Assets().Exists(fileToService + _variants[index].Extension) == true) && (Fields::SetVary(*response, _T("Accept-Encoding")) == true)) {
+                            if ((fileName == fileToService) && (Accepts(encodings, _variants[index].Encoding) == true) && (Fields::SetContentEncoding(*response, _variants[index].Encoding) == true)) {
+                                fileName = fileToService + _variants[index].Extension;
+                            }
+                        }
+                    }
+
+                    fileToService = fileName;
+                }
+
+                // Ranges are cut straight from the file, never from the memory copy.
+                if ((request->Verb != Web::Request::HTTP_GET) || (Fields::Range(*request, range) == false) || (SendFile(*request, response, fileToService) == false)) {
+
+                    // Small files are served from memory, with validators so clients can revalidate what they have.
+                    bool cached = (request->Verb == Web::Request::HTTP_GET) && (_parent.Assets().Use(fileToService, [&](const AssetCache::Asset& asset) {
+                        Fields::SetETag(*response, asset.ETag);
+                        Fields::SetModified(*response, asset.Modified);
+
+                        if (NotModified(*request, asset) == true) {
+                            response->ErrorCode = Web::STATUS_NOT_MODIFIED;
+                            response->Message = _T("Not Modified");
+                        } else {
+                            Core::ProxyType<Web::TextBody> body(_textBodies.Element());
+
+                            *body = asset.Content;
+                            response->Body<Web::TextBody>(body);
+                        }
+                    }));
+
+                    if (cached == true) {
+                        Respond(response);
+                    } else if ((request->Verb != Web::Request::HTTP_GET) || (SendFile(*request, response, fileToService) == false)) {
+                        Core::ProxyType<Web::FileBody> fileBody(PluginHost::Factories::Instance().FileBody());
+
+                        *fileBody = fileToService;
+                        response->Body<Web::FileBody>(fileBody);
+
+                        Respond(response);
+                    }
+                }
             }
-            Submit(response);
         }
     }
 
@@ -770,8 +2149,35 @@ namespace Plugin {
         ASSERT(_outstandingMessages.empty() == false);
         ASSERT(_outstandingMessages.front().Request.IsValid() == false);
 
+        // The idle check runs on the timer thread.
+        _route.Lock();
+
+        _active = true;
+
         if (_outstandingMessages.empty() == false) {
-            _proxyMap.Submit(_outstandingMessages.front().Id, response);
+            const OutstandingMessage& message(_outstandingMessages.front());
+
+            if (message.Key.empty() == true) {
+                _proxyMap.Submit(message.Id, response);
+            } else if (response->ErrorCode == Web::STATUS_NOT_MODIFIED) {
+                // A 304 is never kept, it has no body. It refreshes what we have if it is about our copy.
+                string tag;
+
+                if ((message.Cached != nullptr) && ((message.Conditional == false) || ((Fields::ETag(*response, tag) == true) && (tag == message.Cached->ETag)))) {
+                    _proxyMap.Responses().Refresh(message.Key, message.Cached, *response);
+                }
+
+                if ((message.Cached != nullptr) && (message.Conditional == false)) {
+                    // Our copy is still good, the client gets that one.
+                    _proxyMap.Reply(message.Id, *message.Cached, string());
+                } else {
+                    _proxyMap.Submit(message.Id, response);
+                }
+            } else {
+                _proxyMap.Responses().Store(message.Key, message.Credentials, *response);
+                _proxyMap.Submit(message.Id, response);
+            }
+
             _outstandingMessages.pop_front();
 
             // See if ther is a next one to send.
@@ -782,6 +2188,8 @@ namespace Plugin {
                 Submit(_outstandingMessages.front().Request);
             }
         }
+
+        _route.Unlock();
     }
 
 } /* namespace Plugin */